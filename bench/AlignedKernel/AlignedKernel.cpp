@@ -0,0 +1,70 @@
+// Speed of a vectorizable kernel (saxpy) on arena arrays with different
+// alignments: deliberately misaligned, the default alignment for the
+// element type, and cache-line aligned via NewAligned (where the kernel
+// also tells the compiler about the alignment).
+
+#include <ocxxr-main.hpp>
+
+#include "../bench-util.hpp"
+
+// small enough to stay in L1, so loads and stores dominate
+static constexpr u32 kLength = 2048;
+static constexpr u32 kReps = 20000;
+
+template <size_t kAlignment>
+void Saxpy(float a, const float *__restrict__ x,
+           float *__restrict__ y) {
+    if (kAlignment > 0) {
+        x = static_cast<const float *>(
+                __builtin_assume_aligned(x, kAlignment));
+        y = static_cast<float *>(__builtin_assume_aligned(y, kAlignment));
+    }
+    for (u32 i = 0; i < kLength; i++) {
+        y[i] = a * x[i] + y[i];
+    }
+}
+
+template <size_t kAlignment>
+void Run(const char *name, float *x, float *y) {
+    for (u32 i = 0; i < kLength; i++) {
+        x[i] = i;
+        y[i] = 0;
+    }
+    const double ns = bench::NanosPerOp(u64{kLength} * kReps, [&] {
+        for (u32 rep = 0; rep < kReps; rep++) {
+            Saxpy<kAlignment>(1e-3f, x, y);
+            bench::DoNotOptimize(y);
+        }
+    });
+    PRINTF("%-12s %10.3f\n", name, ns);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<void>::Create(8 * kLength * sizeof(float));
+    PRINTF("saxpy on arena arrays (ns per element)\n");
+    {
+        ocxxr::ArenaScope scope(arena);
+        // one float past a cache line boundary
+        float *x = ocxxr::NewAligned<float>(kLength + 1, 64) + 1;
+        float *y = ocxxr::NewAligned<float>(kLength + 1, 64) + 1;
+        Run<0>("misaligned", x, y);
+    }
+    {
+        ocxxr::ArenaScope scope(arena);
+        ocxxr::New<char>();
+        float *x = ocxxr::NewArray<float>(kLength);
+        ocxxr::New<char>();
+        float *y = ocxxr::NewArray<float>(kLength);
+        Run<0>("default", x, y);
+    }
+    {
+        ocxxr::ArenaScope scope(arena);
+        ocxxr::New<char>();
+        float *x = ocxxr::NewAligned<float>(kLength, 64);
+        ocxxr::New<char>();
+        float *y = ocxxr::NewAligned<float>(kLength, 64);
+        Run<64>("aligned-64", x, y);
+    }
+    arena.Destroy();
+    ocxxr::Shutdown();
+}
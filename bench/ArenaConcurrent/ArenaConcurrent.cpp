@@ -0,0 +1,98 @@
+// Scaling of parallel allocation from one shared arena.
+//
+// Each worker allocates (and writes) kOps small objects in the same arena.
+// Threads stand in for OCR workers, so the allocator is measured the same
+// way on any OCR build. Compares:
+//   locked   - a plain (fixed-mode) arena behind a mutex
+//   atomic   - ArenaMode::kConcurrent, one fetch-and-add per allocation
+//   chunked  - ArenaMode::kConcurrent, with a private ArenaChunk per worker
+
+#include <ocxxr-main.hpp>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../bench-util.hpp"
+
+static constexpr u32 kOps = 200000;
+static constexpr u32 kMaxWorkers = 8;
+static constexpr size_t kChunkBytes = 64 * 1024;
+
+struct Object {
+    u64 key;
+    u64 value;
+    ocxxr::RelPtr<Object> next;
+    u64 padding;
+};
+
+static constexpr u32 kObjectsPerChunk = kChunkBytes / sizeof(Object);
+
+static Object *Fill(Object *object, u32 i) {
+    object->key = i;
+    object->value = i * 3;
+    return object;
+}
+
+void LockedWorker(ocxxr::Arena<void> arena, std::mutex *mutex) {
+    for (u32 i = 0; i < kOps; i++) {
+        Object *object;
+        {
+            std::lock_guard<std::mutex> lock(*mutex);
+            object = arena.New<Object>();
+        }
+        bench::DoNotOptimize(Fill(object, i));
+    }
+}
+
+void AtomicWorker(ocxxr::Arena<void> arena, std::mutex *) {
+    for (u32 i = 0; i < kOps; i++) {
+        bench::DoNotOptimize(Fill(arena.New<Object>(), i));
+    }
+}
+
+void ChunkedWorker(ocxxr::Arena<void> arena, std::mutex *) {
+    for (u32 i = 0; i < kOps;) {
+        ocxxr::ArenaChunk chunk(arena, kChunkBytes);
+        for (u32 j = 0; j < kObjectsPerChunk && i < kOps; j++, i++) {
+            bench::DoNotOptimize(Fill(chunk.New<Object>(), i));
+        }
+    }
+}
+
+typedef void (*Worker)(ocxxr::Arena<void>, std::mutex *);
+
+double Run(Worker worker, u32 mode, u32 workers) {
+    const u64 bytes = u64{workers} * (kOps + 2 * kObjectsPerChunk) *
+                      sizeof(Object);
+    return bench::NanosPerOp(u64{workers} * kOps, [&] {
+        auto arena = ocxxr::Arena<void>::Create(bytes, mode);
+        std::mutex mutex;
+        std::vector<std::thread> threads;
+        for (u32 w = 0; w < workers; w++) {
+            threads.emplace_back(worker, arena, &mutex);
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        arena.Destroy();
+    });
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Parallel arena allocation (ns per object, %" PRIu32
+           " objects per worker, %u hardware threads)\n",
+           kOps, std::thread::hardware_concurrency());
+    PRINTF("%8s %12s %12s %12s\n", "workers", "locked", "atomic", "chunked");
+    for (u32 workers = 1; workers <= kMaxWorkers; workers *= 2) {
+        const double locked_ns =
+                Run(&LockedWorker, ocxxr::ArenaMode::kFixed, workers);
+        const double atomic_ns =
+                Run(&AtomicWorker, ocxxr::ArenaMode::kConcurrent, workers);
+        const double chunked_ns =
+                Run(&ChunkedWorker, ocxxr::ArenaMode::kConcurrent, workers);
+        PRINTF("%8" PRIu32 " %12.2f %12.2f %12.2f\n", workers, locked_ns,
+               atomic_ns, chunked_ns);
+    }
+    ocxxr::Shutdown();
+}
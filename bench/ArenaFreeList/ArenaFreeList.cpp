@@ -0,0 +1,120 @@
+// Throughput of arena allocation with size-class free lists, compared with
+// plain bump allocation and with malloc/free.
+//
+// The "churn" workload keeps a fixed number of objects alive, repeatedly
+// replacing a random one with an object of a different size, like a
+// long-running task updating a tree or hash table in an arena.
+
+#include <ocxxr-main.hpp>
+
+#include <cstdlib>
+
+#include "../bench-util.hpp"
+
+static constexpr u32 kOps = 200000;
+static constexpr u32 kLive = 1024;
+
+namespace dballoc = ocxxr::internal::dballoc;
+
+// Object sizes between 8 and 512 bytes, skewed towards small ones
+static size_t SizeFor(u32 i) {
+    const u32 hash = i * 2654435761u;
+    return size_t{8} << (hash >> 29) % 7;
+}
+
+static u32 SlotFor(u32 i) { return (i * 40503u) % kLive; }
+
+struct MallocAllocator {
+    void *Allocate(size_t bytes) { return std::malloc(bytes); }
+    void Free(void *ptr, size_t) { std::free(ptr); }
+};
+
+struct ArenaAllocator {
+    explicit ArenaAllocator(ocxxr::Arena<void> arena)
+            : allocator(arena.base_ptr()) {}
+
+    void *Allocate(size_t bytes) { return allocator.allocate(bytes); }
+    void Free(void *ptr, size_t bytes) { allocator.deallocate(ptr, bytes, 1); }
+
+    dballoc::DatablockAllocator allocator;
+};
+
+// Allocate kOps objects without freeing any of them
+template <typename A>
+double AllocOnly(A allocator, void **objects) {
+    return bench::NanosPerOp(
+            kOps,
+            [&] {
+                for (u32 i = 0; i < kOps; i++) {
+                    objects[i] = allocator.Allocate(SizeFor(i));
+                    *static_cast<char *>(objects[i]) = 1;
+                }
+                for (u32 i = 0; i < kOps; i++) {
+                    allocator.Free(objects[i], SizeFor(i));
+                }
+            },
+            1);
+}
+
+template <typename A>
+double Churn(A allocator, void **objects) {
+    for (u32 i = 0; i < kLive; i++) {
+        objects[i] = allocator.Allocate(SizeFor(i));
+    }
+    const double ns = bench::NanosPerOp(
+            kOps,
+            [&] {
+                for (u32 i = kLive; i < kLive + kOps; i++) {
+                    const u32 slot = SlotFor(i);
+                    // slot contents always have the size of the last index
+                    // that mapped there, which we track via the object
+                    allocator.Free(objects[slot],
+                                   *static_cast<size_t *>(objects[slot]));
+                    const size_t size = SizeFor(i);
+                    objects[slot] = allocator.Allocate(size);
+                    *static_cast<size_t *>(objects[slot]) = size;
+                }
+            },
+            1);
+    for (u32 i = 0; i < kLive; i++) {
+        allocator.Free(objects[i], *static_cast<size_t *>(objects[i]));
+    }
+    return ns;
+}
+
+// enough for every allocation without reuse
+static constexpr u64 kArenaBytes = u64{512} * (kOps + kLive) + (1 << 16);
+
+void RunArena(const char *name, u32 mode, void **objects) {
+    auto arena = ocxxr::Arena<void>::Create(kArenaBytes, mode);
+    const double alloc_ns = AllocOnly(ArenaAllocator(arena), objects);
+    arena.Destroy();
+    auto churn_arena = ocxxr::Arena<void>::Create(kArenaBytes, mode);
+    const double churn_ns = Churn(ArenaAllocator(churn_arena), objects);
+    // bytes used by bump allocation in the arena datablock
+    auto header = static_cast<dballoc::DbArenaHeader *>(churn_arena.base_ptr());
+    PRINTF("%-12s %12.1f %12.1f %14" PRId64 "\n", name, alloc_ns, churn_ns,
+           static_cast<s64>(header->offset));
+    churn_arena.Destroy();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto objects = OCXXR_TEMP_ARRAY_NEW(void *, kOps);
+
+    PRINTF("Arena allocation cost (ns per operation, %" PRIu32 " ops)\n",
+           kOps);
+    PRINTF("%-12s %12s %12s %14s\n", "allocator", "alloc-only", "churn",
+           "churn-bytes");
+
+    RunArena("bump", ocxxr::ArenaMode::kFixed, objects);
+    RunArena("free-list", ocxxr::ArenaMode::kFreeList, objects);
+    {
+        const double alloc_ns = AllocOnly(MallocAllocator(), objects);
+        const double churn_ns = Churn(MallocAllocator(), objects);
+        PRINTF("%-12s %12.1f %12.1f %14s\n", "malloc", alloc_ns, churn_ns,
+               "-");
+    }
+
+    OCXXR_TEMP_ARRAY_DELETE(objects);
+    ocxxr::Shutdown();
+}
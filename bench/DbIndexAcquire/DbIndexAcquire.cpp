@@ -0,0 +1,74 @@
+// Cost of the per-task acquired-datablock bookkeeping, as a function of
+// the number of datablocks a task has acquired.
+
+#include <ocxxr-main.hpp>
+
+#include "../bench-util.hpp"
+
+namespace bk = ocxxr::internal::bookkeeping;
+
+static constexpr u32 kCounts[] = {1, 4, 16, 64, 256, 1024, 4096, 10000};
+// spacing between fake datablock base addresses
+static constexpr size_t kFakeDbBytes = 64;
+
+void RunWithCount(u32 count) {
+    // Real GUIDs, but fake (non-acquired) base addresses
+    auto guids = OCXXR_TEMP_ARRAY_NEW(ocrGuid_t, count);
+    auto bases = OCXXR_TEMP_ARRAY_NEW(char, count * kFakeDbBytes);
+    for (u32 i = 0; i < count; i++) {
+        guids[i] = ocxxr::DatablockHandle<u64>::Create().guid();
+    }
+
+    double add_ns = 0, guid_ns = 0, addr_ns = 0, remove_ns = 0;
+    constexpr int kRuns = 5;
+    for (int run = 0; run < kRuns; run++) {
+        bench::Timer timer;
+        for (u32 i = 0; i < count; i++) {
+            bk::AddDatablock(guids[i], &bases[i * kFakeDbBytes]);
+        }
+        add_ns += timer.ElapsedNanos();
+
+        timer.Reset();
+        for (u32 i = 0; i < count; i++) {
+            bench::DoNotOptimize(ocxxr::internal::AddressForGuid(guids[i]));
+        }
+        guid_ns += timer.ElapsedNanos();
+
+        timer.Reset();
+        for (u32 i = 0; i < count; i++) {
+            ocrGuid_t guid;
+            ptrdiff_t offset;
+            // source address is outside of every fake datablock
+            ocxxr::internal::GuidOffsetForAddress(
+                    &bases[i * kFakeDbBytes + 8], &guid, &guid, &offset);
+            bench::DoNotOptimize(offset);
+        }
+        addr_ns += timer.ElapsedNanos();
+
+        timer.Reset();
+        for (u32 i = 0; i < count; i++) {
+            bk::RemoveDatablock(guids[i]);
+        }
+        remove_ns += timer.ElapsedNanos();
+    }
+
+    const double ops = static_cast<double>(count) * kRuns;
+    PRINTF("%8" PRIu32 " %12.1f %12.1f %12.1f %12.1f\n", count, add_ns / ops,
+           guid_ns / ops, addr_ns / ops, remove_ns / ops);
+
+    for (u32 i = 0; i < count; i++) {
+        ocxxr::DatablockHandle<u64>(guids[i]).Destroy();
+    }
+    OCXXR_TEMP_ARRAY_DELETE(bases);
+    OCXXR_TEMP_ARRAY_DELETE(guids);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Datablock bookkeeping cost (ns per operation)\n");
+    PRINTF("%8s %12s %12s %12s %12s\n", "DBs", "acquire", "by-guid",
+           "by-address", "release");
+    for (u32 count : kCounts) {
+        RunWithCount(count);
+    }
+    ocxxr::Shutdown();
+}
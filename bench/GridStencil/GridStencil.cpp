@@ -0,0 +1,137 @@
+// Cost of a 5-point stencil sweep over a 2D grid stored as an array of
+// RelPtr row pointers (as in the Grid2D test), and as a single contiguous
+// block viewed through GridView with each layout. Each variant is swept
+// row by row, and then one 8x8 block at a time (the order that suits the
+// tiled and Morton layouts). The grid sizes aren't powers of two, since
+// rows whose size is a power of two alias in the cache.
+
+#include <ocxxr-main.hpp>
+
+#include <algorithm>
+
+#include "../bench-util.hpp"
+
+static constexpr u32 kSweeps = 4;
+static constexpr size_t kBlock = 8;
+
+// Grid2D-style grid: an arena-allocated array of row pointers
+class RowPointerGrid {
+ public:
+    RowPointerGrid(size_t rows, size_t cols)
+            : rows_(ocxxr::NewArray<ocxxr::RelPtr<double>>(rows)) {
+        for (size_t r = 0; r < rows; r++) {
+            rows_[r] = ocxxr::NewArray<double>(cols);
+        }
+    }
+
+    double &operator()(size_t row, size_t col) const {
+        return rows_[row][col];
+    }
+
+ private:
+    ocxxr::RelPtr<ocxxr::RelPtr<double>> rows_;
+};
+
+template <typename Grid>
+void Fill(const Grid &grid, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            grid(i, j) = (i * 7 + j * 3) % 10;
+        }
+    }
+}
+
+// Sweep row by row
+template <typename Grid>
+void RowSweep(const Grid &in, const Grid &out, size_t n) {
+    for (size_t i = 1; i < n - 1; i++) {
+        for (size_t j = 1; j < n - 1; j++) {
+            out(i, j) = 0.25 * (in(i - 1, j) + in(i + 1, j) + in(i, j - 1) +
+                                in(i, j + 1));
+        }
+    }
+}
+
+// Sweep one kBlock x kBlock block at a time (aligned to the tiles, and
+// clipped to the interior of the grid)
+template <typename Grid>
+void BlockSweep(const Grid &in, const Grid &out, size_t n) {
+    for (size_t bi = 0; bi < n - 1; bi += kBlock) {
+        for (size_t bj = 0; bj < n - 1; bj += kBlock) {
+            const size_t end_i = std::min(bi + kBlock, n - 1);
+            const size_t end_j = std::min(bj + kBlock, n - 1);
+            for (size_t i = std::max<size_t>(bi, 1); i < end_i; i++) {
+                for (size_t j = std::max<size_t>(bj, 1); j < end_j; j++) {
+                    out(i, j) = 0.25 * (in(i - 1, j) + in(i + 1, j) +
+                                        in(i, j - 1) + in(i, j + 1));
+                }
+            }
+        }
+    }
+}
+
+// ns per grid point, sweeping back and forth between two grids
+template <typename Grid>
+double Run(const Grid &a, const Grid &b, size_t n, bool blocked) {
+    Fill(a, n);
+    Fill(b, n);
+    const double ns = bench::NanosPerOp(kSweeps * (n - 2) * (n - 2), [&] {
+        for (u32 s = 0; s < kSweeps; s += 2) {
+            if (blocked) {
+                BlockSweep(a, b, n);
+                BlockSweep(b, a, n);
+            } else {
+                RowSweep(a, b, n);
+                RowSweep(b, a, n);
+            }
+        }
+    });
+    bench::DoNotOptimize(a(n / 2, n / 2));
+    return ns;
+}
+
+template <typename Layout>
+double RunView(size_t n, bool blocked) {
+    typedef ocxxr::GridView<double, ocxxr::Dims<2>, Layout> Grid;
+    const ocxxr::Dims<2> dims(n, n);
+    auto a = ocxxr::ArrayDatablock<double>::Create(Grid::RequiredSize(dims));
+    auto b = ocxxr::ArrayDatablock<double>::Create(Grid::RequiredSize(dims));
+    const double ns = Run(Grid(a.data(), dims), Grid(b.data(), dims), n,
+                          blocked);
+    a.Destroy();
+    b.Destroy();
+    return ns;
+}
+
+double RunRowPointers(size_t n, bool blocked) {
+    const size_t bytes = 2 * n * (n * sizeof(double) + 64) + 4096;
+    auto arena = ocxxr::Arena<void>::Create(bytes);
+    ocxxr::SetImplicitArena(arena);
+    const double ns = Run(RowPointerGrid(n, n), RowPointerGrid(n, n), n,
+                          blocked);
+    arena.Destroy();
+    return ns;
+}
+
+void PrintTable(bool blocked) {
+    PRINTF("\n%s sweep:\n", blocked ? "Block-by-block" : "Row-by-row");
+    PRINTF("%6s %10s %10s %10s %10s %10s\n", "n", "row-ptrs", "row-major",
+           "col-major", "tiled", "morton");
+    for (size_t n = 250; n <= 1000; n *= 2) {
+        const double row_pointers = RunRowPointers(n, blocked);
+        const double row_major = RunView<ocxxr::RowMajor>(n, blocked);
+        const double column_major = RunView<ocxxr::ColumnMajor>(n, blocked);
+        const double tiled = RunView<ocxxr::Tiled<kBlock, kBlock>>(n, blocked);
+        const double morton = RunView<ocxxr::Morton>(n, blocked);
+        PRINTF("%6zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", n, row_pointers,
+               row_major, column_major, tiled, morton);
+    }
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("5-point stencil sweep (ns per point, %" PRIu32 " sweeps)\n",
+           kSweeps);
+    PrintTable(false);
+    PrintTable(true);
+    ocxxr::Shutdown();
+}
@@ -0,0 +1,208 @@
+// Cost of building and traversing linked structures that span several
+// datablocks, using raw pointers, RelPtr, BasedPtr (with and without the
+// per-task lookup caches, and swizzled before traversing), and
+// CompactBasedPtr.
+
+#include <ocxxr-main.hpp>
+
+#include "../bench-util.hpp"
+
+// the list is spread over fewer datablocks than the tree
+static constexpr u32 kListDbs = 8;
+static constexpr u32 kTreeDbs = 64;
+static constexpr u32 kNodesPerDb = 1024;
+static constexpr u32 kListNodes = kListDbs * kNodesPerDb;
+static constexpr u32 kTreeNodes = kTreeDbs * kNodesPerDb;
+static constexpr u32 kSearches = 100000;
+
+template <typename T>
+using RawPtr = T *;
+
+template <template <typename...> class P>
+struct ListNode {
+    u64 value;
+    P<ListNode> next;
+};
+
+template <template <typename...> class P>
+struct TreeNode {
+    u64 key;
+    P<TreeNode> left;
+    P<TreeNode> right;
+};
+
+// (only the BasedPtr structures get swizzled)
+namespace ocxxr {
+
+template <>
+struct PointerFields<ListNode<BasedPtr>> {
+    template <typename V>
+    static void Visit(ListNode<BasedPtr> &node, V &visitor) {
+        visitor(node.next);
+    }
+};
+
+template <>
+struct PointerFields<TreeNode<BasedPtr>> {
+    template <typename V>
+    static void Visit(TreeNode<BasedPtr> &node, V &visitor) {
+        visitor(node.left);
+        visitor(node.right);
+    }
+};
+
+}  // namespace ocxxr
+
+static constexpr size_t kDbBytes =
+        kNodesPerDb * sizeof(TreeNode<ocxxr::BasedPtr>);
+
+struct UncachedPolicy : ocxxr::DefaultTaskPolicy {
+    static constexpr bool kCacheLookups = false;
+};
+
+enum Variant {
+    kRaw,
+    kRelative,
+    kBasedCached,
+    kBasedUncached,
+    kBasedSwizzled,
+    kCompactBased,
+    kVariants
+};
+
+// Node i of a structure spread over the first db_count datablocks
+template <typename N>
+N *NodeAt(ocxxr::DatablockList<char> &dbs, u32 db_count, u32 i) {
+    // scatter consecutive nodes across datablocks
+    const u32 db = (i * 2654435761u) % db_count;
+    return reinterpret_cast<N *>(dbs[db].data_ptr()) + i / db_count;
+}
+
+template <template <typename...> class P>
+TreeNode<P> *BuildTree(ocxxr::DatablockList<char> &dbs, u32 lo, u32 hi) {
+    if (lo >= hi) return nullptr;
+    const u32 mid = lo + (hi - lo) / 2;
+    auto node = NodeAt<TreeNode<P>>(dbs, kTreeDbs, mid);
+    node->key = mid;
+    node->left = BuildTree<P>(dbs, lo, mid);
+    node->right = BuildTree<P>(dbs, mid + 1, hi);
+    return node;
+}
+
+// (the traversals of swizzled structures don't include the swizzling)
+template <template <typename...> class P>
+void Run(const char *name, ocxxr::DatablockList<char> &dbs,
+         bool swizzle = false) {
+    typedef ListNode<P> LN;
+    typedef TreeNode<P> TN;
+    LN *head = NodeAt<LN>(dbs, kListDbs, 0);
+
+    const double list_build_ns = bench::NanosPerOp(kListNodes, [&] {
+        for (u32 i = 0; i < kListNodes; i++) {
+            LN *node = NodeAt<LN>(dbs, kListDbs, i);
+            node->value = i;
+            if (i + 1 < kListNodes) {
+                node->next = NodeAt<LN>(dbs, kListDbs, i + 1);
+            } else {
+                node->next = nullptr;
+            }
+        }
+    });
+
+    double list_walk_ns;
+    {
+        ocxxr::SwizzleScope<LN> swizzled(swizzle ? head : nullptr);
+        list_walk_ns = bench::NanosPerOp(kListNodes, [&] {
+            u64 sum = 0;
+            for (LN *node = head; node; node = node->next) {
+                sum += node->value;
+            }
+            ASSERT(sum == u64{kListNodes} * (kListNodes - 1) / 2);
+            bench::DoNotOptimize(sum);
+        });
+    }
+
+    TN *root = nullptr;
+    const double tree_build_ns = bench::NanosPerOp(kTreeNodes, [&] {
+        root = BuildTree<P>(dbs, 0, kTreeNodes);
+    });
+
+    ocxxr::SwizzleScope<TN> swizzled(swizzle ? root : nullptr);
+    u64 hops = 0;
+    const double search_ns = bench::NanosPerOp(1, [&] {
+        hops = 0;
+        u32 key = 0;
+        for (u32 i = 0; i < kSearches; i++) {
+            key = (key + 40503) % kTreeNodes;
+            TN *node = root;
+            while (node->key != key) {
+                node = (key < node->key) ? node->left : node->right;
+                ++hops;
+            }
+        }
+    });
+
+    PRINTF("%-18s %12.1f %12.1f %12.1f %12.1f\n", name, list_build_ns,
+           list_walk_ns, tree_build_ns, search_ns / hops);
+}
+
+void BenchTask(u32 variant, ocxxr::DatablockList<char> dbs) {
+    switch (variant) {
+        case kRaw:
+            Run<RawPtr>("raw pointer", dbs);
+            break;
+        case kRelative:
+            Run<ocxxr::RelPtr>("RelPtr", dbs);
+            break;
+        case kBasedCached:
+            Run<ocxxr::BasedPtr>("BasedPtr", dbs);
+            break;
+        case kBasedUncached:
+            Run<ocxxr::BasedPtr>("BasedPtr (no cache)", dbs);
+            break;
+        case kBasedSwizzled:
+            Run<ocxxr::BasedPtr>("BasedPtr (swizzled)", dbs, true);
+            break;
+        case kCompactBased: {
+            // the GUID table lives in the implicit arena
+            auto table = ocxxr::Arena<void>::Create(
+                    0, ocxxr::ArenaMode::kGuidTable);
+            ocxxr::SetImplicitArena(table);
+            Run<ocxxr::CompactBasedPtr>("CompactBasedPtr", dbs);
+            table.Destroy();
+            break;
+        }
+    }
+    const u32 next = variant + 1;
+    if (next == kVariants) {
+        for (auto db : dbs) {
+            db.Destroy();
+        }
+        ocxxr::Shutdown();
+        return;
+    }
+    ocxxr::DatablockList<char> next_dbs(dbs.count());
+    for (auto db : dbs) {
+        db.Release();
+        next_dbs.Add(db);
+    }
+    typedef ocxxr::TaskTemplate<decltype(BenchTask)> Template;
+    auto task_template = (next == kBasedUncached)
+                                 ? Template::Create<BenchTask, UncachedPolicy>()
+                                 : Template::Create<BenchTask>();
+    task_template().CreateTask(next, next_dbs);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Linked structure cost (ns per link built or followed)\n");
+    PRINTF("%-18s %12s %12s %12s %12s\n", "pointer", "list-build",
+           "list-walk", "tree-build", "tree-search");
+    ocxxr::DatablockList<char> dbs(kTreeDbs);
+    for (u32 i = 0; i < kTreeDbs; i++) {
+        auto db = ocxxr::Datablock<char>::Create(kDbBytes);
+        db.Release();
+        dbs.Add(db);
+    }
+    auto task_template = OCXXR_TEMPLATE_FOR(BenchTask);
+    task_template().CreateTask(kRaw, dbs);
+}
@@ -0,0 +1,87 @@
+// Lookup throughput of a RelHashMap that lives in an arena datablock,
+// compared with a std::unordered_map that each task has to rebuild from
+// the flat key/value records it receives.
+//
+// Each simulated task looks up every key once (in a scrambled order).
+// The arena map is built once, up front; its build time is reported
+// separately, since it's only paid by the task that creates the index.
+
+#include <ocxxr-main.hpp>
+
+#include <unordered_map>
+
+#include "../bench-util.hpp"
+
+static constexpr u32 kTasks = 4;
+
+typedef ocxxr::RelHashMap<u64, u64> Map;
+
+struct Record {
+    u64 first;
+    u64 second;
+};
+
+static u64 KeyFor(u32 i) { return u64{i} * 0x9E3779B97F4A7C15ull >> 16; }
+
+// Visits each index below n once (n is a power of two)
+static u32 ScrambledIndex(u32 i, u32 n) { return (i * 40503u) & (n - 1); }
+
+template <typename M>
+static u64 LookUpAll(const M &map, u32 n) {
+    u64 sum = 0;
+    for (u32 i = 0; i < n; i++) {
+        sum += map.find(KeyFor(ScrambledIndex(i, n)))->second;
+    }
+    return sum;
+}
+
+void RunSize(u32 n) {
+    auto records = OCXXR_TEMP_ARRAY_NEW(Record, n);
+    for (u32 i = 0; i < n; i++) {
+        records[i] = {KeyFor(i), i};
+    }
+    const u64 expected_sum = u64{n} * (n - 1) / 2;
+    static_cast<void>(expected_sum);  // unused if asserts are disabled
+
+    // enough for the slots and control bytes at the maximum load
+    const u64 arena_bytes = u64{n} * 2 * (sizeof(Record) + 1) + (1 << 16);
+    auto arena = ocxxr::Arena<Map>::Create(arena_bytes);
+    ocxxr::SetImplicitArena(arena);
+    Map *map = ocxxr::New<Map>();
+    const double build_ns = bench::NanosPerOp(
+            n, [&] { map->InsertAll(records, n); }, 1);
+    const double rel_ns = bench::NanosPerOp(u64{kTasks} * n, [&] {
+        for (u32 t = 0; t < kTasks; t++) {
+            const u64 sum = LookUpAll(*map, n);
+            ASSERT(sum == expected_sum);
+            bench::DoNotOptimize(sum);
+        }
+    });
+    arena.Destroy();
+
+    const double std_ns = bench::NanosPerOp(u64{kTasks} * n, [&] {
+        for (u32 t = 0; t < kTasks; t++) {
+            std::unordered_map<u64, u64> rebuilt(n);
+            for (u32 i = 0; i < n; i++) {
+                rebuilt.emplace(records[i].first, records[i].second);
+            }
+            const u64 sum = LookUpAll(rebuilt, n);
+            ASSERT(sum == expected_sum);
+            bench::DoNotOptimize(sum);
+        }
+    });
+
+    PRINTF("%10" PRIu32 " %12.1f %12.1f %14.1f\n", n, build_ns, rel_ns,
+           std_ns);
+    OCXXR_TEMP_ARRAY_DELETE(records);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Hash map cost per lookup (ns, %" PRIu32 " tasks)\n", kTasks);
+    PRINTF("%10s %12s %12s %14s\n", "entries", "rel-build", "rel-lookup",
+           "std-rebuild");
+    RunSize(1 << 10);
+    RunSize(1 << 16);
+    RunSize(1 << 20);
+    ocxxr::Shutdown();
+}
@@ -0,0 +1,114 @@
+// Cost of walking an array through a raw pointer, a RelPtr, and a BasedPtr.
+//
+// Indexing a RelPtr skips the null check, so with ASSERT compiled out the
+// indexed RelPtr loop should compile to the same (vectorized) code as the
+// raw pointer loop. Iterating compares against the end pointer through the
+// null-checking conversion to T *, which keeps that loop scalar.
+// The BasedPtr loop converts to a raw pointer once, outside the loop.
+
+#include <ocxxr-main.hpp>
+
+#include "../bench-util.hpp"
+
+static constexpr u32 kCount = 1 << 16;
+static constexpr u32 kRuns = 200;
+
+// The array and the pointers to its ends live in the same datablock
+template <typename T>
+struct Range {
+    ocxxr::RelPtr<T> begin;
+    ocxxr::RelPtr<T> end;
+    ocxxr::BasedPtr<T> based;
+};
+
+template <typename T>
+T SumRaw(const T *begin, const T *end) {
+    T sum = 0;
+    for (const T *p = begin; p != end; ++p) {
+        sum += *p;
+    }
+    return sum;
+}
+
+template <typename T>
+T SumRelIterator(const Range<T> &range) {
+    T sum = 0;
+    for (ocxxr::RelPtr<T> p = range.begin; p != range.end; ++p) {
+        sum += *p;
+    }
+    return sum;
+}
+
+template <typename T>
+T SumRelIndex(const Range<T> &range, size_t count) {
+    T sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += range.begin[i];
+    }
+    return sum;
+}
+
+template <typename T>
+T SumBased(const Range<T> &range, size_t count) {
+    const T *values = range.based;
+    return SumRaw(values, values + count);
+}
+
+template <typename T>
+void Run(const char *name) {
+    auto arena = ocxxr::Arena<Range<T>>::Create(kCount * sizeof(T) + 4096);
+    ocxxr::SetImplicitArena(arena);
+    Range<T> *range = ocxxr::New<Range<T>>();
+    T *values = ocxxr::NewArray<T>(kCount);
+    for (u32 i = 0; i < kCount; i++) {
+        values[i] = static_cast<T>(i);
+    }
+    range->begin = values;
+    range->end = values + kCount;
+    range->based = values;
+    const T expected = SumRaw(values, values + kCount);
+    const size_t ops = size_t{kCount} * kRuns;
+
+    const double raw_ns = bench::NanosPerOp(ops, [&] {
+        for (u32 r = 0; r < kRuns; r++) {
+            bench::DoNotOptimize(values);
+            bench::DoNotOptimize(SumRaw<T>(values, values + kCount));
+        }
+    });
+    const double iterator_ns = bench::NanosPerOp(ops, [&] {
+        for (u32 r = 0; r < kRuns; r++) {
+            bench::DoNotOptimize(range);
+            bench::DoNotOptimize(SumRelIterator(*range));
+        }
+    });
+    const double index_ns = bench::NanosPerOp(ops, [&] {
+        for (u32 r = 0; r < kRuns; r++) {
+            bench::DoNotOptimize(range);
+            bench::DoNotOptimize(SumRelIndex(*range, kCount));
+        }
+    });
+    const double based_ns = bench::NanosPerOp(ops, [&] {
+        for (u32 r = 0; r < kRuns; r++) {
+            bench::DoNotOptimize(range);
+            bench::DoNotOptimize(SumBased(*range, kCount));
+        }
+    });
+    ASSERT(SumRelIterator(*range) == expected);
+    ASSERT(SumRelIndex(*range, kCount) == expected);
+    ASSERT(SumBased(*range, kCount) == expected);
+    static_cast<void>(expected);  // unused if asserts are disabled
+
+    PRINTF("%-6s %12.3f %12.3f %12.3f %12.3f\n", name, raw_ns, iterator_ns,
+           index_ns, based_ns);
+    arena.Destroy();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Array sum (ns per element, %" PRIu32 " elements)\n", kCount);
+    PRINTF("%-6s %12s %12s %12s %12s\n", "type", "raw", "rel-iter",
+           "rel-index", "based");
+    Run<u32>("u32");
+    Run<u64>("u64");
+    Run<float>("float");
+    ocxxr::Shutdown();
+}
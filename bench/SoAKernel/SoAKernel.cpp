@@ -0,0 +1,114 @@
+// Speed of particle kernels over an array of structs (in an arena) and
+// over an ocxxr::SoA with the same fields: a position update that touches
+// most of the fields (using the SoA's columns, and its proxies), and a sum
+// that touches a single field.
+
+#include <ocxxr-main.hpp>
+
+#include "../bench-util.hpp"
+
+// small enough to stay in L2
+static constexpr u32 kParticles = 8192;
+static constexpr u32 kReps = 2000;
+static constexpr float kDt = 1e-3f;
+
+struct Particle {
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    u32 id;
+};
+
+typedef ocxxr::SoA<float, float, float, float, float, float, float, u32>
+        Particles;
+
+void MoveAoS(Particle *__restrict__ p) {
+    for (u32 i = 0; i < kParticles; i++) {
+        p[i].x += kDt * p[i].vx;
+        p[i].y += kDt * p[i].vy;
+        p[i].z += kDt * p[i].vz;
+    }
+}
+
+u32 SumIdsAoS(const Particle *p) {
+    u32 total = 0;
+    for (u32 i = 0; i < kParticles; i++) {
+        total += p[i].id;
+    }
+    return total;
+}
+
+void MoveColumns(float *__restrict__ x, float *__restrict__ y,
+                 float *__restrict__ z, const float *__restrict__ vx,
+                 const float *__restrict__ vy, const float *__restrict__ vz) {
+    for (u32 i = 0; i < kParticles; i++) {
+        x[i] += kDt * vx[i];
+        y[i] += kDt * vy[i];
+        z[i] += kDt * vz[i];
+    }
+}
+
+void MoveColumns(Particles &p) {
+    MoveColumns(p.column<0>(), p.column<1>(), p.column<2>(), p.column<3>(),
+                p.column<4>(), p.column<5>());
+}
+
+u32 SumIdsColumns(const Particles &p) {
+    const u32 *ids = p.column<7>();
+    u32 total = 0;
+    for (u32 i = 0; i < kParticles; i++) {
+        total += ids[i];
+    }
+    return total;
+}
+
+void MoveProxies(Particles &particles) {
+    for (Particles::reference p : particles) {
+        p.get<0>() += kDt * p.get<3>();
+        p.get<1>() += kDt * p.get<4>();
+        p.get<2>() += kDt * p.get<5>();
+    }
+}
+
+template <typename F>
+void Run(const char *name, F kernel) {
+    const double ns = bench::NanosPerOp(u64{kParticles} * kReps, [&] {
+        for (u32 rep = 0; rep < kReps; rep++) {
+            kernel();
+        }
+    });
+    PRINTF("%-16s %10.3f\n", name, ns);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    const size_t bytes = 4 * kParticles * sizeof(Particle);
+    auto arena = ocxxr::Arena<void>::Create(bytes);
+    ocxxr::SetImplicitArena(arena);
+    Particle *aos = ocxxr::NewArray<Particle>(kParticles);
+    for (u32 i = 0; i < kParticles; i++) {
+        aos[i] = {0, 0, 0, 1.0f * i, 2.0f, 3.0f, 1.0f, i};
+    }
+    Particles &soa = *ocxxr::New<Particles>(kParticles);
+    soa.CopyFromAoS(aos, kParticles, &Particle::x, &Particle::y,
+                    &Particle::z, &Particle::vx, &Particle::vy, &Particle::vz,
+                    &Particle::mass, &Particle::id);
+
+    PRINTF("Particle kernels (ns per particle, %" PRIu32 " particles)\n",
+           kParticles);
+    Run("move aos", [&] {
+        MoveAoS(aos);
+        bench::DoNotOptimize(aos);
+    });
+    Run("move soa", [&] {
+        MoveColumns(soa);
+        bench::DoNotOptimize(soa.column<0>());
+    });
+    Run("move soa-proxy", [&] {
+        MoveProxies(soa);
+        bench::DoNotOptimize(soa.column<0>());
+    });
+    Run("sum-ids aos", [&] { bench::DoNotOptimize(SumIdsAoS(aos)); });
+    Run("sum-ids soa", [&] { bench::DoNotOptimize(SumIdsColumns(soa)); });
+    arena.Destroy();
+    ocxxr::Shutdown();
+}
@@ -0,0 +1,106 @@
+// Cost of launching var-args tasks with many datablock dependences, and of
+// registering those dependences in the task's datablock bookkeeping.
+
+#include <ocxxr-main.hpp>
+
+#include "../bench-util.hpp"
+
+namespace bk = ocxxr::internal::bookkeeping;
+
+static constexpr u32 kCounts[] = {16, 64, 256, 1024, 4096};
+static constexpr u32 kCountsSize = sizeof(kCounts) / sizeof(kCounts[0]);
+static constexpr u32 kLaunches = 100;
+// spacing between fake datablock base addresses
+static constexpr size_t kFakeDbBytes = 64;
+
+struct LaunchState {
+    u32 count_index;
+    u32 remaining;
+};
+
+static bench::Timer launch_timer;
+
+void StartLaunches(u32 count_index);
+
+void LaunchTask(ocxxr::Datablock<LaunchState> state,
+                ocxxr::DatablockList<u64> deps) {
+    if (state->remaining > 0) {
+        state->remaining--;
+        ocxxr::DatablockList<u64> next(deps.count());
+        for (auto db : deps) {
+            next.Add(db);
+        }
+        auto task_template = OCXXR_TEMPLATE_FOR(LaunchTask);
+        task_template().CreateTask(state, next);
+        return;
+    }
+    const u32 count = kCounts[state->count_index];
+    const double ns = launch_timer.ElapsedNanos() / kLaunches;
+    PRINTF("%8" PRIu32 " %14.1f\n", count, ns);
+    for (auto db : deps) {
+        db.Destroy();
+    }
+    const u32 next_index = state->count_index + 1;
+    state.Destroy();
+    if (next_index < kCountsSize) {
+        StartLaunches(next_index);
+    } else {
+        ocxxr::Shutdown();
+    }
+}
+
+void StartLaunches(u32 count_index) {
+    const u32 count = kCounts[count_index];
+    auto state = ocxxr::Datablock<LaunchState>::Create();
+    state->count_index = count_index;
+    state->remaining = kLaunches - 1;
+    ocxxr::DatablockList<u64> deps(count);
+    for (u32 i = 0; i < count; i++) {
+        deps.Add(ocxxr::Datablock<u64>::Create());
+    }
+    launch_timer.Reset();
+    auto task_template = OCXXR_TEMPLATE_FOR(LaunchTask);
+    task_template().CreateTask(state, deps);
+}
+
+// Registration only: the whole depv at once vs. one dependence at a time
+void RunRegistration(u32 count) {
+    auto depv = OCXXR_TEMP_ARRAY_NEW(ocrEdtDep_t, count);
+    auto bases = OCXXR_TEMP_ARRAY_NEW(char, count * kFakeDbBytes);
+    for (u32 i = 0; i < count; i++) {
+        depv[i].guid = ocxxr::DatablockHandle<u64>::Create().guid();
+        // shuffle the base addresses to avoid presorted input
+        depv[i].ptr = &bases[((i * 7919) % count) * kFakeDbBytes];
+    }
+
+    const double bulk_ns = bench::NanosPerOp(count, [&] {
+        ocxxr::internal::PushTaskState();
+        bk::AddDatablocks(count, depv);
+        ocxxr::internal::PopTaskState();
+    });
+    const double single_ns = bench::NanosPerOp(count, [&] {
+        ocxxr::internal::PushTaskState();
+        for (u32 i = 0; i < count; i++) {
+            bk::AddDatablock(depv[i].guid, depv[i].ptr);
+        }
+        ocxxr::internal::PopTaskState();
+    });
+    PRINTF("%8" PRIu32 " %14.1f %14.1f\n", count, bulk_ns, single_ns);
+
+    for (u32 i = 0; i < count; i++) {
+        ocxxr::DatablockHandle<u64>(depv[i].guid).Destroy();
+    }
+    OCXXR_TEMP_ARRAY_DELETE(bases);
+    OCXXR_TEMP_ARRAY_DELETE(depv);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Dependence registration cost (ns per dependence)\n");
+    PRINTF("%8s %14s %14s\n", "deps", "bulk", "one-by-one");
+    for (u32 count : kCounts) {
+        RunRegistration(count);
+    }
+    PRINTF("\nVar-args task launch cost (ns per task)\n");
+    PRINTF("%8s %14s\n", "deps", "launch");
+    StartLaunches(0);
+}
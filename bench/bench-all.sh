@@ -0,0 +1,20 @@
+#!/bin/bash
+
+set -e
+
+bench_count=0
+divider='\n================================================================\n'
+
+for dir in *; do
+    if [ -d "$dir" ] && [ $dir != makefiles ]; then
+        printf $divider
+        printf "> Running benchmark %s\n\n" $dir
+        pushd $dir
+        make -f Makefile.x86 clean run WORKLOAD_ARGS="$BENCH_ARGS"
+        popd
+        bench_count=$((bench_count+1))
+    fi
+done
+
+printf $divider
+printf "> Ran %d benchmarks.\n\n" $bench_count
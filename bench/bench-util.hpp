@@ -0,0 +1,50 @@
+#ifndef OCXXR_BENCH_UTIL_HPP_
+#define OCXXR_BENCH_UTIL_HPP_
+
+// Shared helpers for the ocxxr micro-benchmarks
+
+#include <chrono>
+#include <cstddef>
+
+namespace bench {
+
+/// Wall-clock stopwatch.
+class Timer {
+ public:
+    Timer() : start_(Clock::now()) {}
+
+    void Reset() { start_ = Clock::now(); }
+
+    double ElapsedNanos() const {
+        auto elapsed = Clock::now() - start_;
+        return std::chrono::duration<double, std::nano>(elapsed).count();
+    }
+
+ private:
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start_;
+};
+
+/// Keep the compiler from optimizing away a computed value.
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @brief Run a benchmark body several times.
+/// @return the best observed time per operation, in nanoseconds.
+template <typename F>
+double NanosPerOp(size_t ops_per_run, F body, int runs = 5) {
+    double best = 0;
+    for (int i = 0; i < runs; i++) {
+        Timer timer;
+        body();
+        double elapsed = timer.ElapsedNanos();
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+    return ops_per_run ? best / ops_per_run : best;
+}
+
+}  // namespace bench
+
+#endif  // OCXXR_BENCH_UTIL_HPP_
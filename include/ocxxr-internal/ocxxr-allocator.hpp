@@ -0,0 +1,165 @@
+#ifndef OCXXR_ALLOCATOR_HPP_
+#define OCXXR_ALLOCATOR_HPP_
+
+#include <iterator>
+#include <memory>
+
+namespace ocxxr {
+namespace internal {
+
+/**
+ * The "fancy pointer" type used by ArenaAllocator.
+ *
+ * This is a RelPtr that also meets the standard library's requirements for
+ * an allocator's pointer type: it's null when value-initialized, and it
+ * works as a random-access iterator (the arithmetic results are relative
+ * pointers too).
+ */
+template <typename T>
+class AllocatorRelPtr : public RelPtr<T> {
+ public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_cv<T>::type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+
+    AllocatorRelPtr() : RelPtr<T>(static_cast<T *>(nullptr)) {}
+
+    AllocatorRelPtr(std::nullptr_t) : AllocatorRelPtr() {}
+
+    AllocatorRelPtr(T *ptr) : RelPtr<T>(ptr) {}
+
+    AllocatorRelPtr(const AllocatorRelPtr &other) : RelPtr<T>(other) {}
+
+    template <typename U, typename = typename std::enable_if<
+                                  std::is_convertible<U *, T *>::value>::type>
+    AllocatorRelPtr(const AllocatorRelPtr<U> &other)
+            : RelPtr<T>(static_cast<U *>(other)) {}
+
+    AllocatorRelPtr &operator=(const AllocatorRelPtr &other) {
+        RelPtr<T>::operator=(other);
+        return *this;
+    }
+
+    static AllocatorRelPtr pointer_to(T &target) {
+        return AllocatorRelPtr(std::addressof(target));
+    }
+
+    AllocatorRelPtr &operator+=(difference_type n) {
+        RelPtr<T>::operator+=(n);
+        return *this;
+    }
+
+    AllocatorRelPtr &operator-=(difference_type n) {
+        RelPtr<T>::operator-=(n);
+        return *this;
+    }
+
+    AllocatorRelPtr &operator++() { return *this += 1; }
+
+    AllocatorRelPtr &operator--() { return *this -= 1; }
+
+    AllocatorRelPtr operator++(int) {
+        AllocatorRelPtr old(*this);
+        *this += 1;
+        return old;
+    }
+
+    AllocatorRelPtr operator--(int) {
+        AllocatorRelPtr old(*this);
+        *this -= 1;
+        return old;
+    }
+
+    AllocatorRelPtr operator+(difference_type n) const { return get() + n; }
+
+    AllocatorRelPtr operator-(difference_type n) const { return get() - n; }
+
+    difference_type operator-(const AllocatorRelPtr &other) const {
+        return get() - other.get();
+    }
+
+    T &operator[](difference_type index) const { return get()[index]; }
+
+ private:
+    T *get() const { return *this; }
+};
+
+template <typename T>
+AllocatorRelPtr<T> operator+(ptrdiff_t n, const AllocatorRelPtr<T> &ptr) {
+    return ptr + n;
+}
+
+}  // namespace internal
+
+/**
+ * Standard library allocator for the current implicit arena.
+ *
+ * Lets standard containers keep their contents in an arena datablock, so
+ * they can be handed off to other tasks along with the rest of the arena:
+ *
+ *     struct Root {
+ *         std::vector<u32, ocxxr::ArenaAllocator<u32>> values;
+ *     };
+ *     ocxxr::SetImplicitArena(arena);
+ *     Root *root = ocxxr::New<Root>();
+ *     root->values.push_back(1);
+ *
+ * The allocator's pointer type is a relative pointer, so containers that
+ * store their pointers using that type (e.g., std::vector and
+ * std::basic_string) are relocatable when the container object is in
+ * the arena too. Other containers (e.g., std::list and std::map in
+ * libstdc++) convert to raw pointers internally, so they can allocate
+ * in an arena but can't be moved with it.
+ *
+ * The allocator is stateless: it always uses the implicit arena of the
+ * running task (see SetImplicitArena and ArenaScope). Memory is only
+ * reclaimed if that arena uses ArenaMode::kFreeList, so containers that
+ * grow a lot should use a free-list arena, or reserve their capacity.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+    typedef T value_type;
+    typedef internal::AllocatorRelPtr<T> pointer;
+    typedef internal::AllocatorRelPtr<const T> const_pointer;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef std::true_type is_always_equal;
+    typedef std::true_type propagate_on_container_move_assignment;
+
+    template <typename U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator() = default;
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &) {}
+
+    pointer allocate(size_t count) {
+        auto arena = internal::dballoc::AllocatorGet();
+        return static_cast<T *>(arena.allocate(sizeof(T), count, alignof(T)));
+    }
+
+    void deallocate(pointer ptr, size_t count) {
+        auto arena = internal::dballoc::AllocatorGet();
+        arena.deallocate(static_cast<T *>(ptr), sizeof(T), count);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &, const ArenaAllocator<U> &) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &, const ArenaAllocator<U> &) {
+    return false;
+}
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_ALLOCATOR_HPP_
@@ -0,0 +1,128 @@
+#ifndef OCXXR_ARENA_FILE_HPP_
+#define OCXXR_ARENA_FILE_HPP_
+
+#include <cstdio>
+#include <cstring>
+
+namespace ocxxr {
+namespace internal {
+namespace dballoc {
+
+// Bump this when the arena datablock layout changes
+constexpr u32 kArenaFileVersion = 1;
+
+constexpr char kArenaFileMagic[8] = {'O', 'C', 'X', 'X', 'R', 'A', 'R', 'N'};
+
+// Header at the start of a saved arena file (followed by the image)
+struct ArenaFileHeader {
+    char magic[8];
+    u32 version;       // kArenaFileVersion
+    u32 header_bytes;  // sizeof(DbArenaHeader), which depends on the build
+    u64 type_hash;     // ArenaTypeHash of the root type
+    s64 size;          // size of the arena datablock
+    s64 image_bytes;   // bytes of the datablock stored in the file
+};
+
+// FNV-1a hash of the root type's name and layout
+template <typename T>
+u64 ArenaTypeHash() {
+    u64 hash = 0xCBF29CE484222325ull;
+    const std::string name = TypeName<T>();
+    for (char c : name) {
+        hash = (hash ^ static_cast<u8>(c)) * 0x100000001B3ull;
+    }
+    return (hash ^ SizeOf<T>::Value) * 0x100000001B3ull;
+}
+
+inline ArenaFileHeader ArenaFileHeaderFor(u64 type_hash, s64 size,
+                                          s64 image_bytes) {
+    ArenaFileHeader header;
+    std::memcpy(header.magic, kArenaFileMagic, sizeof(header.magic));
+    header.version = kArenaFileVersion;
+    header.header_bytes = sizeof(DbArenaHeader);
+    header.type_hash = type_hash;
+    header.size = size;
+    header.image_bytes = image_bytes;
+    return header;
+}
+
+inline bool SaveArenaImage(const char *path, const DbArenaHeader *info,
+                           u64 type_hash) {
+    ASSERT(ocrGuidIsNull(info->next) && "Can't save a chained arena");
+    // the unused space at the end doesn't need to be saved,
+    // unless it holds the free-list table or the GUID table
+    const bool has_tables =
+            info->free_lists || (info->mode & ArenaMode::kGuidTable);
+    const s64 image_bytes = has_tables ? info->size : info->offset;
+    const ArenaFileHeader header =
+            ArenaFileHeaderFor(type_hash, info->size, image_bytes);
+    std::FILE *file = std::fopen(path, "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(info, 1, image_bytes, file) ==
+                      static_cast<size_t>(image_bytes);
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Read a saved arena into a new (acquired) datablock.
+// Returns a null dependence if the file is missing or doesn't match.
+inline ocrEdtDep_t LoadArenaImage(const char *path, u64 type_hash) {
+    ocrEdtDep_t dep = {};
+    dep.guid = NULL_GUID;
+    dep.ptr = nullptr;
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file) return dep;
+    ArenaFileHeader header;
+    const ArenaFileHeader expected = ArenaFileHeaderFor(type_hash, 0, 0);
+    const bool valid =
+            std::fread(&header, sizeof(header), 1, file) == 1 &&
+            std::memcmp(header.magic, expected.magic, sizeof(header.magic)) ==
+                    0 &&
+            header.version == expected.version &&
+            header.header_bytes == expected.header_bytes &&
+            header.type_hash == expected.type_hash &&
+            header.image_bytes >= static_cast<s64>(sizeof(DbArenaHeader)) &&
+            header.image_bytes <= header.size;
+    if (valid) {
+        // stream the image straight into the new datablock
+        char *buf;
+        const DatablockHandle<char> handle(&buf, header.size, nullptr);
+        DbArenaHeader *info = reinterpret_cast<DbArenaHeader *>(buf);
+        const size_t image_bytes = static_cast<size_t>(header.image_bytes);
+        if (std::fread(buf, 1, image_bytes, file) == image_bytes &&
+            info->size == header.size && ocrGuidIsNull(info->next)) {
+            dep.guid = handle.guid();
+            dep.ptr = buf;
+            if (info->mode & ArenaMode::kGuidTable) {
+                // only the arena's own datablock is still valid
+                GuidTable &table = GuidTableOf(info);
+                table.count = 1;
+                table.guids[0] = handle.guid();
+            }
+        } else {
+            handle.Destroy();
+        }
+    }
+    std::fclose(file);
+    return dep;
+}
+
+}  // namespace dballoc
+}  // namespace internal
+
+template <typename T>
+bool Arena<T>::SaveTo(const char *path) const {
+    return internal::dballoc::SaveArenaImage(
+            path, &state_->header, internal::dballoc::ArenaTypeHash<T>());
+}
+
+template <typename T>
+Arena<T> Arena<T>::LoadFrom(const char *path) {
+    return Arena<T>(internal::dballoc::LoadArenaImage(
+            path, internal::dballoc::ArenaTypeHash<T>()));
+}
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_ARENA_FILE_HPP_
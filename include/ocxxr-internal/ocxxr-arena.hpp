@@ -1,71 +1,563 @@
 #ifndef OCXXR_ARENA_HPP_
 #define OCXXR_ARENA_HPP_
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <string>
+
+#ifdef OCXXR_ARENA_STATS
+#include <mutex>
+#endif
 
 // TODO - Rename variables (imported from older repo)
 // TODO - Get rid of C-style casts
 
+// Assumed cache line size (in bytes), used to keep data from sharing lines
+#ifndef OCXXR_CACHE_LINE_SIZE
+#define OCXXR_CACHE_LINE_SIZE 64
+#endif
+
+// Define OCXXR_ARENA_STATS to record allocation statistics for each arena
+// (see ArenaStats). This adds a little work to every allocation, and makes
+// the arena headers bigger, so it's off by default.
+
 namespace ocxxr {
 
+/**
+ * Allocation statistics for an arena (see Arena#stats).
+ *
+ * Only recorded if OCXXR_ARENA_STATS is defined. The counts are kept in
+ * the arena's header, so they follow the arena from task to task.
+ */
+struct ArenaStats {
+    /// Number of allocations (including reused free blocks)
+    u64 allocations;
+    /// Bytes requested by those allocations
+    u64 requested_bytes;
+    /// Bytes lost to alignment and to rounding up to a size class
+    u64 padding_bytes;
+    /// Peak bytes used in the arena's datablocks (including headers)
+    s64 high_water;
+};
+
+/// Arena allocation modes
+struct ArenaMode {
+    /// Allocations must fit in the arena's datablock (default)
+    static constexpr u32 kFixed = 0;
+    /// @brief Chain additional datablocks onto the arena as it fills up.
+    ///
+    /// Objects in different datablocks of the chain must refer to each
+    /// other using BasedPtr (not RelPtr), and tasks using the arena must
+    /// also acquire the rest of the chain (see Arena#Chain).
+    static constexpr u32 kChained = 1 << 0;
+    /// @brief Keep size-class free lists so deleted objects can be reused.
+    ///
+    /// Freed memory is tracked by offsets within each datablock, so the
+    /// arena can still be copied or moved as a unit. Objects are released
+    /// with ocxxr::Delete and ocxxr::DeleteArray (or Arena#Delete and
+    /// Arena#DeleteArray). In the other modes these only run destructors.
+    static constexpr u32 kFreeList = 1 << 1;
+    /// @brief Allow parallel tasks to allocate from the same arena.
+    ///
+    /// For arenas that several tasks acquire at once (e.g., in
+    /// AccessMode::kReadWrite) on shared-memory OCR. Each allocation bumps
+    /// the offset with an atomic operation; a task that allocates a lot
+    /// can reserve an ArenaChunk to allocate from privately. Concurrent
+    /// arenas can't be combined with the other modes, and must not be
+    /// rolled back (e.g., by an ArenaScope checkpoint) while shared.
+    static constexpr u32 kConcurrent = 1 << 2;
+    /// @brief Keep a table of datablock GUIDs for CompactBasedPtr.
+    ///
+    /// The table takes the end of the arena's first datablock, and lists
+    /// that datablock, any chained datablocks, and any other datablocks
+    /// that CompactBasedPtrs in the arena have pointed to (up to
+    /// OCXXR_ARENA_GUID_TABLE_SIZE in total).
+    static constexpr u32 kGuidTable = 1 << 3;
+};
+
 namespace internal {
 
 namespace dballoc {
 
 struct AllocatorState {
+    ocrGuid_t tail;
     ptrdiff_t offset;
 };
 
+// Header at the start of each arena datablock.
+// Fields marked "head only" are only used in an arena's first datablock.
 struct DbArenaHeader {
+    s64 size;           // usable bytes in this datablock (including header)
+    ptrdiff_t offset;   // bump-allocation offset within this datablock
+    ocrGuid_t next;     // next datablock in the chain (or NULL_GUID)
+    ocrGuid_t tail;     // head only: datablock currently used for allocation
+                        // (NULL_GUID if it's the head)
+    s64 chain_size;     // head only: total size of the chained datablocks
+    u32 mode;           // head only: ArenaMode flags
+    u32 chain_length;   // head only: number of chained datablocks
+    ptrdiff_t free_lists;  // offset of this datablock's FreeLists table
+                           // (0 unless the arena uses ArenaMode::kFreeList)
+    s64 free_bytes;     // bytes currently on this datablock's free lists
+#ifdef OCXXR_ARENA_STATS
+    ArenaStats stats;   // high_water is for this datablock; the other
+                        // counts are head only
+#endif
+};
+
+// Freed memory is sorted into size classes of 16-byte steps up to 128 bytes,
+// and then 4 classes per power of two up to kMaxSmallBytes (1 MiB).
+// Allocations are rounded up to their size class, so freed blocks can be
+// reused without splitting (which leads to fragmentation).
+constexpr size_t kSmallStepClasses = 8;
+constexpr size_t kSizeClassCount = kSmallStepClasses + 4 * (20 - 7);
+constexpr size_t kMaxSmallBytes = size_t{1} << 20;
+
+inline size_t SizeClassFor(size_t bytes) {
+    if (bytes <= 16 * kSmallStepClasses) {
+        return bytes <= 16 ? 0 : (bytes - 1) / 16;
+    }
+    // find the power-of-two range (128, 256], (256, 512], ...
+    int shift = 7;
+    while ((size_t{2} << shift) < bytes) shift++;
+    const size_t quarter = (bytes - 1 - (size_t{1} << shift)) >> (shift - 2);
+    return kSmallStepClasses + 4 * (shift - 7) + quarter;
+}
+
+inline size_t SizeClassBytes(size_t size_class) {
+    if (size_class < kSmallStepClasses) return 16 * (size_class + 1);
+    const size_t steps = size_class - kSmallStepClasses;
+    const int shift = 7 + static_cast<int>(steps / 4);
+    return (size_t{1} << shift) + (steps % 4 + 1) * (size_t{1} << (shift - 2));
+}
+
+// Free-list heads for one datablock, stored at the end of the datablock.
+// Each list links free blocks by their offsets within the datablock
+// (0 marks the end of a list), so it doesn't depend on the base address.
+struct FreeLists {
+    ptrdiff_t small[kSizeClassCount];
+    // first-fit list of blocks bigger than kMaxSmallBytes
+    ptrdiff_t large;
+    ptrdiff_t padding;
+};
+
+// Stored in each free block
+struct FreeBlock {
+    ptrdiff_t next;
     s64 size;
-    ptrdiff_t offset;
 };
 
+// Maximum number of datablocks in an arena's GUID table
+// (see ArenaMode::kGuidTable)
+#ifndef OCXXR_ARENA_GUID_TABLE_SIZE
+#define OCXXR_ARENA_GUID_TABLE_SIZE 128
+#endif
+
+// GUIDs of the datablocks that an arena's CompactBasedPtrs can point into,
+// stored before the free-list table (if any) at the end of the arena's
+// first datablock. Entry 0 is that datablock itself.
+struct GuidTable {
+    u32 count;
+    u32 padding;
+    ocrGuid_t guids[OCXXR_ARENA_GUID_TABLE_SIZE];
+};
+
+// Offset of the GUID table in an arena's first datablock
+inline ptrdiff_t GuidTableOffset(const DbArenaHeader *info) {
+    const ptrdiff_t end = info->free_lists ? info->free_lists : info->size;
+    return (end - sizeof(GuidTable)) & -16;
+}
+
+inline GuidTable &GuidTableOf(DbArenaHeader *info) {
+    assert((info->mode & ArenaMode::kGuidTable) && "Arena has no GUID table");
+    return *reinterpret_cast<GuidTable *>(reinterpret_cast<char *>(info) +
+                                          GuidTableOffset(info));
+}
+
+// Index of a datablock in an arena's GUID table (adding it if necessary)
+inline u32 GuidTableIndex(DbArenaHeader *head, ocrGuid_t guid) {
+    GuidTable &table = GuidTableOf(head);
+    for (u32 i = 0; i < table.count; i++) {
+        if (ocrGuidIsEq(table.guids[i], guid)) return i;
+    }
+    assert(table.count < OCXXR_ARENA_GUID_TABLE_SIZE &&
+           "Arena GUID table is full");
+    table.guids[table.count] = guid;
+    return table.count++;
+}
+
+// The root object is placed directly after the header
+static_assert(sizeof(DbArenaHeader) % 16 == 0,
+              "Arena header size must be a multiple of the root alignment");
+
+inline void AllocatorDbInit(void *dbPtr, size_t dbSize,
+                            u32 mode = ArenaMode::kFixed) {
+    DbArenaHeader *const info = static_cast<DbArenaHeader *>(dbPtr);
+    assert(dbSize >= sizeof(*info) && "Datablock is too small for allocator");
+    assert((mode == ArenaMode::kConcurrent ||
+            !(mode & ArenaMode::kConcurrent)) &&
+           "Concurrent arenas can't be combined with other modes");
+    info->size = dbSize;
+    info->offset = sizeof(*info);
+    info->next = NULL_GUID;
+    info->tail = NULL_GUID;
+    info->chain_size = 0;
+    info->mode = mode;
+    info->chain_length = 0;
+    info->free_lists = 0;
+    info->free_bytes = 0;
+#ifdef OCXXR_ARENA_STATS
+    info->stats = ArenaStats();
+    info->stats.high_water = info->offset;
+#endif
+    if (mode & ArenaMode::kFreeList) {
+        // the free-list table takes the (aligned) end of the datablock
+        const ptrdiff_t table = (dbSize - sizeof(FreeLists)) & -16;
+        assert(table >= static_cast<ptrdiff_t>(sizeof(*info)) &&
+               "Datablock is too small for free lists");
+        info->free_lists = table;
+        ::new (reinterpret_cast<char *>(dbPtr) + table) FreeLists();
+    }
+    if (mode & ArenaMode::kGuidTable) {
+        // (the datablock's own GUID is added by its owner)
+        const ptrdiff_t table = GuidTableOffset(info);
+        assert(table >= static_cast<ptrdiff_t>(sizeof(*info)) &&
+               "Datablock is too small for a GUID table");
+        static_cast<void>(table);  // unused if asserts are disabled
+        GuidTableOf(info).count = 0;
+    }
+}
+
+// Bytes to add to an arena datablock for the bookkeeping of the given mode
+inline size_t AllocatorDbOverhead(u32 mode) {
+    size_t bytes = 0;
+    if (mode & ArenaMode::kFreeList) bytes += sizeof(FreeLists) + 16;
+    if (mode & ArenaMode::kGuidTable) bytes += sizeof(GuidTable) + 16;
+    return bytes;
+}
+
+// End of the bump-allocation space in an arena datablock
+inline ptrdiff_t AllocatorDbLimit(const DbArenaHeader *info) {
+    if (info->mode & ArenaMode::kGuidTable) return GuidTableOffset(info);
+    return info->free_lists ? info->free_lists : info->size;
+}
+
+// Update a datablock's high-water mark after bumping its offset
+// (atomically, since concurrent arenas bump the offset in parallel)
+inline void AllocatorDbUpdateStats(DbArenaHeader *info) {
+#ifdef OCXXR_ARENA_STATS
+    const s64 offset = __atomic_load_n(&info->offset, __ATOMIC_RELAXED);
+    s64 peak = __atomic_load_n(&info->stats.high_water, __ATOMIC_RELAXED);
+    while (peak < offset &&
+           !__atomic_compare_exchange_n(&info->stats.high_water, &peak,
+                                        offset, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+    }
+#else
+    (void)info;
+#endif
+}
+
+inline DbArenaHeader *ArenaBlockForGuid(ocrGuid_t guid) {
+    return reinterpret_cast<DbArenaHeader *>(AddressForGuid(guid));
+}
+
 class DatablockAllocator {
  private:
-    char *const m_dbBuf;
     DbArenaHeader *const m_info;
 
+    // Move allocation on to the next datablock in the chain,
+    // creating a new one if necessary.
+    DbArenaHeader *growChain(DbArenaHeader *tail, size_t minBytes) const {
+        const s64 minSize = sizeof(DbArenaHeader) + minBytes;
+        // reuse datablocks left over from a restoreState
+        if (!ocrGuidIsNull(tail->next)) {
+            DbArenaHeader *next = ArenaBlockForGuid(tail->next);
+            if (AllocatorDbLimit(next) >= minSize) {
+                next->offset = sizeof(DbArenaHeader);
+                clearFreeLists(next);
+                m_info->tail = tail->next;
+                return next;
+            }
+        }
+        // each new datablock is at least twice as big as the last
+        s64 size = std::max(2 * tail->size, minSize);
+        size = std::max<s64>(size, minSize + AllocatorDbOverhead(m_info->mode));
+        char *buf;
+        const ocrGuid_t guid =
+                DatablockHandle<char>(&buf, size, nullptr).guid();
+        DbArenaHeader *block = reinterpret_cast<DbArenaHeader *>(buf);
+        AllocatorDbInit(block, size, m_info->mode & ArenaMode::kFreeList);
+        block->next = tail->next;
+        tail->next = guid;
+        m_info->tail = guid;
+        m_info->chain_size += size;
+        m_info->chain_length++;
+        if (m_info->mode & ArenaMode::kGuidTable) {
+            GuidTableIndex(m_info, guid);
+        }
+        return block;
+    }
+
+    static FreeLists &freeListsOf(DbArenaHeader *info) {
+        return *reinterpret_cast<FreeLists *>(reinterpret_cast<char *>(info) +
+                                              info->free_lists);
+    }
+
+    static FreeBlock &freeBlockAt(DbArenaHeader *info, ptrdiff_t offset) {
+        return *reinterpret_cast<FreeBlock *>(reinterpret_cast<char *>(info) +
+                                              offset);
+    }
+
+    static void clearFreeLists(DbArenaHeader *info) {
+        if (info->free_lists) {
+            ::new (&freeListsOf(info)) FreeLists();
+            info->free_bytes = 0;
+        }
+    }
+
+    // Datablock of the arena chain that contains the given address
+    // (nullptr if it isn't in the arena)
+    DbArenaHeader *findBlock(const void *ptr) const {
+        const char *p = static_cast<const char *>(ptr);
+        DbArenaHeader *block = m_info;
+        for (;;) {
+            const char *base = reinterpret_cast<const char *>(block);
+            if (base <= p && p < base + block->size) return block;
+            if (ocrGuidIsNull(block->next)) return nullptr;
+            block = ArenaBlockForGuid(block->next);
+        }
+    }
+
+    DbArenaHeader *blockContaining(const void *ptr) const {
+        DbArenaHeader *block = findBlock(ptr);
+        assert(block && "Deallocated pointer is not in the arena");
+        return block;
+    }
+
+    // Free-list bytes used for an allocation (at least a FreeBlock's worth)
+    static size_t freeListBytes(size_t bytes) {
+        if (bytes > kMaxSmallBytes) return alignOffset(bytes, 16);
+        return SizeClassBytes(SizeClassFor(bytes));
+    }
+
+    // Statistics hooks (no-ops unless OCXXR_ARENA_STATS is defined)
+    void countAllocation(size_t bytes) const {
+#ifdef OCXXR_ARENA_STATS
+        __atomic_fetch_add(&m_info->stats.allocations, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&m_info->stats.requested_bytes, bytes,
+                           __ATOMIC_RELAXED);
+#else
+        (void)bytes;
+#endif
+    }
+
+    void countPadding(size_t bytes) const {
+#ifdef OCXXR_ARENA_STATS
+        __atomic_fetch_add(&m_info->stats.padding_bytes, bytes,
+                           __ATOMIC_RELAXED);
+#else
+        (void)bytes;
+#endif
+    }
+
+    // Reuse a free block from the current datablock, or bump-allocate one
+    void *allocateFromFreeList(size_t size, int alignment) const {
+        const size_t bytes = freeListBytes(size);
+        countPadding(bytes - size);
+        if (alignment > 16) {
+            // free blocks are only 16-byte aligned
+            return allocateAligned(bytes, alignment);
+        }
+        DbArenaHeader *info = currentBlock();
+        FreeLists &lists = freeListsOf(info);
+        ptrdiff_t *link;
+        if (bytes <= kMaxSmallBytes) {
+            // (small requests don't split up the big blocks)
+            link = &lists.small[SizeClassFor(bytes)];
+        } else {
+            // first fit
+            link = &lists.large;
+            while (*link && freeBlockAt(info, *link).size <
+                                    static_cast<s64>(bytes)) {
+                link = &freeBlockAt(info, *link).next;
+            }
+        }
+        if (!*link) return allocateAligned(bytes, 16);
+        const ptrdiff_t offset = *link;
+        FreeBlock &block = freeBlockAt(info, offset);
+        *link = block.next;
+        info->free_bytes -= block.size;
+        const s64 rest = block.size - static_cast<s64>(bytes);
+        if (rest > 0) {
+            // split off the remainder
+            pushFree(info, offset + bytes, rest);
+        }
+        return reinterpret_cast<char *>(info) + offset;
+    }
+
+    // Add a free block to the list for the biggest size class it can hold
+    static void pushFree(DbArenaHeader *info, ptrdiff_t offset, s64 bytes) {
+        FreeLists &lists = freeListsOf(info);
+        ptrdiff_t *head = &lists.large;
+        if (bytes <= static_cast<s64>(kMaxSmallBytes)) {
+            size_t size_class = SizeClassFor(bytes);
+            if (SizeClassBytes(size_class) > static_cast<size_t>(bytes)) {
+                size_class--;
+            }
+            head = &lists.small[size_class];
+        }
+        FreeBlock &block = freeBlockAt(info, offset);
+        block.next = *head;
+        block.size = bytes;
+        *head = offset;
+        info->free_bytes += bytes;
+    }
+
  public:
-    constexpr DatablockAllocator(void) : m_dbBuf(nullptr), m_info(nullptr) {}
+    constexpr DatablockAllocator(void) : m_info(nullptr) {}
 
     DatablockAllocator(void *dbPtr)
-            : m_dbBuf(reinterpret_cast<char *>(dbPtr)),
-              m_info(reinterpret_cast<DbArenaHeader *>(dbPtr)) {}
+            : m_info(reinterpret_cast<DbArenaHeader *>(dbPtr)) {}
+
+    AllocatorState saveState(void) const {
+        assert(m_info != nullptr && "Uninitialized allocator");
+        return {m_info->tail, currentBlock()->offset};
+    }
+
+    // Note: this also forgets any freed memory in the current datablock
+    void restoreState(AllocatorState state) const {
+        m_info->tail = state.tail;
+        DbArenaHeader *info = currentBlock();
+        info->offset = state.offset;
+        clearFreeLists(info);
+    }
 
-    AllocatorState saveState(void) { return {m_info->offset}; }
+    static ptrdiff_t alignOffset(ptrdiff_t offset, int alignment) {
+        return (offset + alignment - 1) & (-alignment);
+    }
+
+    // Offset of the first address at or after base + offset with the given
+    // alignment. (Aligning the address, rather than just the offset, lets
+    // allocations be aligned more strictly than the datablock itself.)
+    static ptrdiff_t alignStart(const void *base, ptrdiff_t offset,
+                                int alignment) {
+        const ptrdiff_t address = reinterpret_cast<intptr_t>(base);
+        return alignOffset(address + offset, alignment) - address;
+    }
 
-    void restoreState(AllocatorState state) { m_info->offset = state.offset; }
+    // first datablock of the arena (nullptr if uninitialized)
+    DbArenaHeader *headBlock(void) const { return m_info; }
+
+    // datablock that allocations currently come from
+    DbArenaHeader *currentBlock(void) const {
+        if (ocrGuidIsNull(m_info->tail)) return m_info;
+        return ArenaBlockForGuid(m_info->tail);
+    }
+
+    // Lock-free bump allocation, for arenas shared by parallel tasks
+    void *allocateConcurrent(size_t size, int alignment) const {
+        // Every allocation is rounded up to 16 bytes, so the offset stays
+        // aligned, and most allocations need just one fetch-and-add
+        const ptrdiff_t bytes = alignOffset(size, 16);
+        size_t padding = bytes - size;
+        ptrdiff_t start;
+        if (alignment <= 16) {
+            start = __atomic_fetch_add(&m_info->offset, bytes,
+                                       __ATOMIC_RELAXED);
+        } else {
+            ptrdiff_t offset =
+                    __atomic_load_n(&m_info->offset, __ATOMIC_RELAXED);
+            do {
+                start = alignStart(m_info, offset, alignment);
+            } while (!__atomic_compare_exchange_n(
+                    &m_info->offset, &offset, start + bytes, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+            padding += start - offset;
+        }
+        assert(start + bytes <= AllocatorDbLimit(m_info) &&
+               "Datablock allocator overflow");
+        countPadding(padding);
+        AllocatorDbUpdateStats(m_info);
+        return reinterpret_cast<char *>(m_info) + start;
+    }
 
     inline void *allocateAligned(size_t size, int alignment) const {
         assert(m_info != nullptr && "Uninitialized allocator");
-        const ptrdiff_t offset = m_info->offset;
-        ptrdiff_t start = (offset + alignment - 1) & (-alignment);
-        m_info->offset = start + size;
-        assert(m_info->offset <= m_info->size &&
-               "Datablock allocator overflow");
-        return &m_dbBuf[start];
+        if (m_info->mode & ArenaMode::kConcurrent) {
+            return allocateConcurrent(size, alignment);
+        }
+        DbArenaHeader *info = currentBlock();
+        ptrdiff_t start = alignStart(info, info->offset, alignment);
+        if (start + static_cast<ptrdiff_t>(size) > AllocatorDbLimit(info)) {
+            assert((m_info->mode & ArenaMode::kChained) &&
+                   "Datablock allocator overflow");
+            info = growChain(info, size + alignment);
+            start = alignStart(info, info->offset, alignment);
+        }
+        countPadding(start - info->offset);
+        info->offset = start + size;
+        AllocatorDbUpdateStats(info);
+        return reinterpret_cast<char *>(info) + start;
     }
 
     // FIXME - I don't know if these alignment checks are sufficient,
     // especially if we do weird things like allocate a char[N]
     // so we have N bytes to store some struct or something.
-    inline void *allocate(size_t size, size_t count) const {
+    static int alignmentFor(size_t size) {
         assert(size > 0);
         if (size == 1) {
-            return allocateAligned(1 * count, 1);
+            return 1;
         } else if (size <= 4) {
-            return allocateAligned(size * count, 4);
+            return 4;
         } else if (size <= 8) {
-            return allocateAligned(size * count, 8);
+            return 8;
         } else {
-            return allocateAligned(size * count, 16);
+            return 16;
         }
     }
 
+    // Alignment for elements of the given size, and at least min_alignment
+    static int alignmentFor(size_t size, size_t min_alignment) {
+        assert((min_alignment & (min_alignment - 1)) == 0 &&
+               "Alignment must be a power of two");
+        return std::max(alignmentFor(size), static_cast<int>(min_alignment));
+    }
+
+    inline void *allocate(size_t size, size_t count,
+                          size_t min_alignment) const {
+        assert(m_info != nullptr && "Uninitialized allocator");
+        const int alignment = alignmentFor(size, min_alignment);
+        countAllocation(size * count);
+        if (m_info->mode & ArenaMode::kFreeList) {
+            return allocateFromFreeList(size * count, alignment);
+        }
+        return allocateAligned(size * count, alignment);
+    }
+
+    inline void *allocate(size_t size, size_t count) const {
+        return allocate(size, count, 1);
+    }
+
+    // Return memory from allocate(size, count) to the arena's free lists.
+    // Does nothing unless the arena uses ArenaMode::kFreeList.
+    inline void deallocate(void *ptr, size_t size, size_t count) const {
+        assert(m_info != nullptr && "Uninitialized allocator");
+        if (!(m_info->mode & ArenaMode::kFreeList) || !ptr) return;
+        DbArenaHeader *info = blockContaining(ptr);
+        const ptrdiff_t offset =
+                static_cast<char *>(ptr) - reinterpret_cast<char *>(info);
+        pushFree(info, offset, freeListBytes(size * count));
+    }
+
     inline void *allocate(size_t size) const { return allocate(size, 1); }
+
+    // Is the address in one of the arena's datablocks?
+    bool contains(const void *ptr) const {
+        return m_info != nullptr && findBlock(ptr) != nullptr;
+    }
 };
 
 // defined in ocxxr-task-state.hpp
@@ -74,11 +566,15 @@ inline DatablockAllocator &AllocatorGet(void);
 // defined in ocxxr-task-state.hpp
 inline void AllocatorSetDb(void *dbPtr);
 
-inline void AllocatorDbInit(void *dbPtr, size_t dbSize) {
-    DbArenaHeader *const info = static_cast<DbArenaHeader *>(dbPtr);
-    assert(dbSize >= sizeof(*info) && "Datablock is too small for allocator");
-    info->size = dbSize;
-    info->offset = sizeof(*info);
+// defined in ocxxr-task-state.hpp
+inline void AllocatorSet(const DatablockAllocator &allocator);
+
+// Return memory to the implicit arena, if it was allocated there.
+// (Arena containers free their storage through the implicit arena, which
+// may not be the arena the storage came from. Such storage is leaked.)
+inline void DeallocateInImplicitArena(void *ptr, size_t size, size_t count) {
+    const DatablockAllocator &arena = AllocatorGet();
+    if (arena.contains(ptr)) arena.deallocate(ptr, size, count);
 }
 
 }  // namespace dballoc
@@ -109,6 +605,9 @@ inline DatablockAllocator &GetCurrentAllocator(void) {
 
 template <typename T>
 T &GetArenaRoot(void *dbPtr) {
+    static_assert(alignof(T) <= 16,
+                  "Arena root type can't be over-aligned. "
+                  "(Allocate over-aligned objects with NewAligned instead.)");
     auto header = static_cast<internal::dballoc::DbArenaHeader *>(dbPtr);
     return *reinterpret_cast<T *>(&header[1]);
 }
@@ -117,7 +616,7 @@ T &GetArenaRoot(void *dbPtr) {
 
 template <typename T, typename... Ts>
 T *NewIn(internal::dballoc::DatablockAllocator arena, Ts &&... args) {
-    auto mem = arena.allocate(sizeof(T));
+    auto mem = arena.allocate(sizeof(T), 1, alignof(T));
     return ::new (mem) T(std::forward<Ts>(args)...);
 }
 
@@ -137,17 +636,137 @@ struct TypeInitializer<
 // NewArray
 
 template <typename T>
-T *NewArrayIn(internal::dballoc::DatablockAllocator arena, size_t count) {
-    T *data = reinterpret_cast<T *>(arena.allocate(sizeof(T), count));
+T *NewAlignedIn(internal::dballoc::DatablockAllocator arena, size_t count,
+                size_t alignment) {
+    ASSERT(alignment >= alignof(T) && "Alignment is too small for the type");
+    T *data = reinterpret_cast<T *>(
+            arena.allocate(sizeof(T), count, alignment));
     for (size_t i = 0; i < count; i++) {
         TypeInitializer<T>::init(data[i]);
     }
     return data;
 }
 
+template <typename T>
+T *NewArrayIn(internal::dballoc::DatablockAllocator arena, size_t count) {
+    return NewAlignedIn<T>(arena, count, alignof(T));
+}
+
+// Delete
+
+template <typename T>
+void DeleteIn(internal::dballoc::DatablockAllocator arena, T *ptr) {
+    if (!ptr) return;
+    ptr->~T();
+    arena.deallocate(ptr, sizeof(T), 1);
+}
+
+// DeleteArray
+
+template <typename T>
+void DeleteArrayIn(internal::dballoc::DatablockAllocator arena, T *data,
+                   size_t count) {
+    if (!data) return;
+    for (size_t i = count; i > 0; i--) {
+        data[i - 1].~T();
+    }
+    arena.deallocate(data, sizeof(T), count);
+}
+
+// Name of a type, taken from the compiler's signature for this function
+template <typename T>
+std::string TypeName() {
+    const char *signature = __PRETTY_FUNCTION__;
+    const char *name = std::strstr(signature, "T = ");
+    if (!name) return signature;
+    name += 4;
+    return std::string(name, std::strcspn(name, ";]"));
+}
+
+#ifdef OCXXR_ARENA_STATS
+
+// Statistics totals for the arenas with one root type
+class ArenaTypeStats {
+ public:
+    explicit ArenaTypeStats(std::string type_name)
+            : type_name_(std::move(type_name)),
+              arenas_(0),
+              totals_(),
+              max_high_water_(0),
+              max_size_(0) {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        next_ = RegistryHead();
+        RegistryHead() = this;
+    }
+
+    void Add(const ArenaStats &stats, s64 size) {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        arenas_++;
+        totals_.allocations += stats.allocations;
+        totals_.requested_bytes += stats.requested_bytes;
+        totals_.padding_bytes += stats.padding_bytes;
+        totals_.high_water += stats.high_water;
+        max_high_water_ = std::max(max_high_water_, stats.high_water);
+        max_size_ = std::max(max_size_, size);
+    }
+
+    static void PrintAll() {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        PRINTF("%-24s %8s %12s %14s %12s %12s %12s\n", "arena root type",
+               "arenas", "allocations", "requested", "padding", "max-peak",
+               "max-size");
+        for (ArenaTypeStats *t = RegistryHead(); t; t = t->next_) {
+            PRINTF("%-24s %8" PRIu64 " %12" PRIu64 " %14" PRIu64
+                   " %12" PRIu64 " %12" PRId64 " %12" PRId64 "\n",
+                   t->type_name_.c_str(), t->arenas_, t->totals_.allocations,
+                   t->totals_.requested_bytes, t->totals_.padding_bytes,
+                   t->max_high_water_, t->max_size_);
+        }
+    }
+
+ private:
+    static ArenaTypeStats *&RegistryHead() {
+        static ArenaTypeStats *head = nullptr;
+        return head;
+    }
+
+    static std::mutex &RegistryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    const std::string type_name_;
+    u64 arenas_;
+    ArenaStats totals_;
+    s64 max_high_water_;
+    s64 max_size_;
+    ArenaTypeStats *next_;
+};
+
+template <typename T>
+ArenaTypeStats &ArenaTypeStatsFor() {
+    static ArenaTypeStats stats(TypeName<T>());
+    return stats;
+}
+
+#endif  // OCXXR_ARENA_STATS
+
 }  // namespace dballoc
 }  // namespace internal
 
+/// @brief Print the statistics totals for each arena root type.
+///
+/// The table shows, for each type `T` of `Arena<T>`, the total counts over
+/// all of those arenas, and the biggest high-water mark and size of any one
+/// of them (which is what `Arena<T>::Create` needs to be big enough for).
+/// Arenas are added to the totals when they're destroyed (or by
+/// Arena#RecordStats). Does nothing unless OCXXR_ARENA_STATS is defined.
+inline void PrintArenaStats() {
+#ifdef OCXXR_ARENA_STATS
+    internal::dballoc::ArenaTypeStats::PrintAll();
+#endif
+}
+
 template <typename T, typename... Ts>
 T *New(Ts &&... args) {
     auto arena = internal::dballoc::AllocatorGet();
@@ -160,6 +779,66 @@ T *NewArray(size_t count) {
     return internal::dballoc::NewArrayIn<T>(arena, count);
 }
 
+/// @brief Allocate an array with (at least) the given alignment.
+///
+/// Useful for SIMD data, which can need stricter alignment than its element
+/// type, e.g., `NewAligned<float>(n, 32)` for AVX loads. The alignment is
+/// for the array's current address; moving the arena's datablock only
+/// preserves the datablock's own alignment (normally 16 bytes).
+/// @param[in] count The number of elements.
+/// @param[in] alignment A power of two, no less than `alignof(T)`.
+template <typename T>
+T *NewAligned(size_t count, size_t alignment) {
+    auto arena = internal::dballoc::AllocatorGet();
+    return internal::dballoc::NewAlignedIn<T>(arena, count, alignment);
+}
+
+/// Allocate an array that starts on a cache line boundary.
+template <typename T>
+T *NewCacheAligned(size_t count) {
+    return NewAligned<T>(count, std::max<size_t>(OCXXR_CACHE_LINE_SIZE,
+                                                 alignof(T)));
+}
+
+/**
+ * A value that gets a cache line to itself.
+ *
+ * Use this for data written by different workers, e.g., per-worker
+ * counters, to avoid false sharing. `New` and `NewArray` honor the
+ * alignment, so `NewArray<CachePadded<u64>>(workers)` puts each counter on
+ * its own cache line.
+ */
+template <typename T>
+struct alignas(OCXXR_CACHE_LINE_SIZE) CachePadded {
+    T value;
+
+    T &operator*() { return value; }
+
+    const T &operator*() const { return value; }
+
+    T *operator->() { return &value; }
+
+    const T *operator->() const { return &value; }
+};
+
+/// @brief Destroy an object allocated with ocxxr::New in the current arena.
+///
+/// The memory is only reused if the arena uses ArenaMode::kFreeList.
+template <typename T>
+void Delete(T *ptr) {
+    auto arena = internal::dballoc::AllocatorGet();
+    internal::dballoc::DeleteIn<T>(arena, ptr);
+}
+
+/// @brief Destroy an array allocated with ocxxr::NewArray in the current arena.
+/// @param[in] data The array.
+/// @param[in] count The number of elements (as passed to NewArray).
+template <typename T>
+void DeleteArray(T *data, size_t count) {
+    auto arena = internal::dballoc::AllocatorGet();
+    internal::dballoc::DeleteArrayIn<T>(arena, data, count);
+}
+
 template <typename T>
 class ArenaHandle : public DatablockHandle<ArenaState<T>> {
  public:
@@ -171,7 +850,9 @@ class ArenaHandle : public DatablockHandle<ArenaState<T>> {
     explicit ArenaHandle(ArenaState<T> **data_ptr, u64 bytes,
                          const DatablockHint *hint)
             : DatablockHandle<ArenaState<T>>(
-                      data_ptr, bytes + sizeof(ArenaState<T>), hint) {
+                      DatablockHandle<ArenaState<T>>::Init(
+                              data_ptr, bytes + sizeof(ArenaState<T>), true,
+                              hint)) {
         ASSERT(bytes >= sizeof(internal::SizeOf<T>) &&
                "Arena must be big enough to hold root object");
     }
@@ -192,10 +873,10 @@ class Arena : public AcquiredData {
             : Arena(nullptr, bytes, &hint) {}
 
     // This version gets called from the task setup code
+    // (which also registers all of the task's dependences in bulk)
     explicit Arena(ocrEdtDep_t dep)
-            : handle_(dep.guid), state_(static_cast<ArenaState<T> *>(dep.ptr)) {
-        internal::bookkeeping::AddDatablock(dep.guid, dep.ptr);
-    }
+            : handle_(dep.guid),
+              state_(static_cast<ArenaState<T> *>(dep.ptr)) {}
 
     // Create empty arena datablock
     explicit Arena(std::nullptr_t np = nullptr)
@@ -203,6 +884,46 @@ class Arena : public AcquiredData {
 
     static Arena<T> Create(u64 bytes) { return Arena<T>(bytes); }
 
+    /// @brief Create and acquire an arena.
+    /// @param[in] bytes Initial size of the arena (not including its header).
+    /// @param[in] mode ArenaMode flags, e.g., ArenaMode::kChained.
+    static Arena<T> Create(u64 bytes, u32 mode) {
+        return Arena<T>(nullptr, bytes, nullptr, mode);
+    }
+
+    /// @brief Copy everything reachable from the root into a new arena.
+    ///
+    /// The new arena is exactly big enough to hold the live objects, with
+    /// the root first, and all of the copied pointers are updated to
+    /// point into the new arena. The object graph is traversed using
+    /// ocxxr::PointerFields, which must be specialized for every type in
+    /// the graph that contains pointers. This arena is left unchanged.
+    /// The new arena keeps this arena's ArenaMode flags, except that it
+    /// isn't chained (so a free-list arena still reuses deleted objects).
+    /// CompactBasedPtrs are re-encoded for the new arena's GUID table,
+    /// which needs the same datablock tracking as assigning them did.
+    /// @see ocxxr::PointerFields
+    Arena<T> Compact() const;
+
+    /// @brief Write this arena's datablock to a file.
+    ///
+    /// Since relative pointers don't depend on the datablock's address, the
+    /// file is a complete image of the arena, which LoadFrom can turn back
+    /// into an arena (e.g., in a later run of the program). The arena can't
+    /// be chained, and the objects in it must only use RelPtr (not BasedPtr)
+    /// to point to each other. (Arena#Compact can turn a chained arena
+    /// into a single datablock.)
+    /// @return false if the file couldn't be written.
+    bool SaveTo(const char *path) const;
+
+    /// @brief Create an arena from a file written by SaveTo.
+    ///
+    /// The file's header records the root type, the arena format and the
+    /// size of the image, so a stale or mismatched file is rejected.
+    /// @return the (acquired) arena, or a null arena if the file is
+    ///         missing, unreadable, or doesn't match this arena type.
+    static Arena<T> LoadFrom(const char *path);
+
     template <typename U = T, internal::EnableIfNotVoid<U> = 0>
     U &data() const {
         // The template type U is only here to get enable_if to work.
@@ -219,6 +940,82 @@ class Arena : public AcquiredData {
 
     s64 size() const { return state_->header.size; }
 
+    /// Bytes of deleted objects waiting for reuse (see ArenaMode::kFreeList).
+    s64 free_bytes() const {
+        s64 total = state_->header.free_bytes;
+        ocrGuid_t guid = state_->header.next;
+        while (!ocrGuidIsNull(guid)) {
+            auto block = internal::dballoc::ArenaBlockForGuid(guid);
+            total += block->free_bytes;
+            guid = block->next;
+        }
+        return total;
+    }
+
+    /// @brief Allocation statistics for this arena (including its chain).
+    ///
+    /// All zero unless OCXXR_ARENA_STATS is defined.
+    ArenaStats stats() const {
+        ArenaStats result = ArenaStats();
+#ifdef OCXXR_ARENA_STATS
+        result = state_->header.stats;
+        ocrGuid_t guid = state_->header.next;
+        while (!ocrGuidIsNull(guid)) {
+            auto block = internal::dballoc::ArenaBlockForGuid(guid);
+            result.high_water += block->stats.high_water;
+            guid = block->next;
+        }
+#endif
+        return result;
+    }
+
+    /// @brief Print this arena's statistics (e.g., at the end of a task).
+    /// @param[in] label Printed along with the statistics.
+    void PrintStats(const char *label) const {
+#ifdef OCXXR_ARENA_STATS
+        const ArenaStats s = stats();
+        PRINTF("Arena %s: %" PRIu64 " allocations, %" PRIu64
+               " bytes requested (%" PRIu64 " padding), peak %" PRId64
+               " of %" PRId64 " bytes\n",
+               label, s.allocations, s.requested_bytes, s.padding_bytes,
+               s.high_water, size() + state_->header.chain_size);
+#else
+        (void)label;
+#endif
+    }
+
+    /// @brief Add this arena's statistics to the totals for its root type.
+    ///
+    /// Destroy does this automatically, so this is only needed for arenas
+    /// that are never destroyed. (See PrintArenaStats.)
+    void RecordStats() const {
+#ifdef OCXXR_ARENA_STATS
+        internal::dballoc::ArenaTypeStatsFor<T>().Add(
+                stats(), size() + state_->header.chain_size);
+#endif
+    }
+
+    /// Number of datablocks chained onto this arena (see ArenaMode::kChained).
+    u32 chain_length() const { return state_->header.chain_length; }
+
+    /// @brief Get the datablocks chained onto this arena.
+    ///
+    /// A task that allocates in, or follows pointers into, a chained arena
+    /// must acquire these too, e.g., by taking them as its VarArgs.
+    DatablockList<void> Chain() const {
+        DatablockList<void> chain(chain_length());
+        ocrGuid_t guid = state_->header.next;
+        while (!ocrGuidIsNull(guid)) {
+            auto block = internal::dballoc::ArenaBlockForGuid(guid);
+            ocrEdtDep_t dep = {};
+            dep.guid = guid;
+            dep.ptr = block;
+            chain.Add(Datablock<void>(dep));
+            guid = block->next;
+        }
+        return chain;
+    }
+
     T *data_ptr() const { return &internal::dballoc::GetArenaRoot<T>(state_); }
 
     T *operator->() const { return data_ptr(); }
@@ -227,7 +1024,27 @@ class Arena : public AcquiredData {
 
     ArenaHandle<T> handle() const { return handle_; }
 
-    void Release() const { internal::OK(ocrDbRelease(handle_.guid())); }
+    /// Release the arena (including any chained datablocks).
+    void Release() const {
+        if (chain_length() > 0) {
+            for (auto block : Chain()) {
+                block.Release();
+            }
+        }
+        internal::OK(ocrDbRelease(handle_.guid()));
+        internal::bookkeeping::RemoveDatablock(handle_.guid());
+    }
+
+    /// Destroy the arena (including any chained datablocks).
+    void Destroy() const {
+        RecordStats();
+        if (chain_length() > 0) {
+            for (auto block : Chain()) {
+                block.Destroy();
+            }
+        }
+        handle_.Destroy();
+    }
 
     operator ArenaHandle<T>() const { return handle(); }
 
@@ -244,13 +1061,45 @@ class Arena : public AcquiredData {
         return internal::dballoc::NewArrayIn<U>(alloc, count);
     }
 
+    template <typename U>
+    U *NewAligned(size_t count, size_t alignment) {
+        auto alloc = internal::dballoc::DatablockAllocator(state_);
+        return internal::dballoc::NewAlignedIn<U>(alloc, count, alignment);
+    }
+
+    template <typename U>
+    void Delete(U *ptr) {
+        auto alloc = internal::dballoc::DatablockAllocator(state_);
+        internal::dballoc::DeleteIn<U>(alloc, ptr);
+    }
+
+    template <typename U>
+    void DeleteArray(U *data, size_t count) {
+        auto alloc = internal::dballoc::DatablockAllocator(state_);
+        internal::dballoc::DeleteArrayIn<U>(alloc, data, count);
+    }
+
     template <typename U>
     friend void SetImplicitArena(Arena<U> arena);
 
  private:
-    Arena(ArenaState<T> *tmp, u64 bytes, const DatablockHint *hint)
-            : handle_(&tmp, bytes, hint), state_(tmp) {
-        internal::dballoc::AllocatorDbInit(state_, bytes);
+    Arena(ArenaState<T> *tmp, u64 bytes, const DatablockHint *hint,
+          u32 mode = ArenaMode::kFixed)
+            : handle_(&tmp,
+                      bytes + internal::dballoc::AllocatorDbOverhead(mode),
+                      hint),
+              state_(tmp) {
+        // the header (and any free-list table) is allocated in addition to
+        // the requested bytes
+        internal::dballoc::AllocatorDbInit(
+                state_,
+                bytes + sizeof(*state_) +
+                        internal::dballoc::AllocatorDbOverhead(mode),
+                mode);
+        if (mode & ArenaMode::kGuidTable) {
+            internal::dballoc::GuidTableIndex(&state_->header,
+                                              handle_.guid());
+        }
     }
 
     const ArenaHandle<T> handle_;
@@ -262,6 +1111,135 @@ void SetImplicitArena(Arena<T> arena) {
     internal::dballoc::SetCurrentArena(arena.state_);
 }
 
+/**
+ * A region of an arena reserved for one task to allocate from.
+ *
+ * Reserving the chunk takes a single allocation from the parent arena, and
+ * allocating within the chunk is then a plain pointer bump, with no
+ * synchronization. This is the fast path for parallel tasks filling one
+ * big structure in an ArenaMode::kConcurrent arena:
+ *
+ *     void FillTask(ocxxr::Arena<Result> result, ...) {
+ *         ocxxr::ArenaChunk chunk(result, 64 * 1024);
+ *         ocxxr::ArenaScope scope(chunk);
+ *         ... ocxxr::New<Node>(...) ...
+ *     }
+ *
+ * The chunk is inside the parent arena's datablock, so objects in it can
+ * use RelPtr to point to the rest of the arena (and vice versa). Space
+ * left over in the chunk isn't returned to the parent.
+ */
+class ArenaChunk {
+ public:
+    /// @brief Reserve a chunk from an arena.
+    /// @param[in] bytes Space for allocations in the chunk.
+    template <typename T>
+    ArenaChunk(Arena<T> arena, size_t bytes)
+            : allocator_(Reserve(arena.base_ptr(), bytes)) {}
+
+    template <typename U, typename... Args>
+    U *New(Args &&... args) const {
+        return internal::dballoc::NewIn<U, Args...>(
+                allocator_, std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    U *NewArray(size_t count) const {
+        return internal::dballoc::NewArrayIn<U>(allocator_, count);
+    }
+
+    template <typename U>
+    U *NewAligned(size_t count, size_t alignment) const {
+        return internal::dballoc::NewAlignedIn<U>(allocator_, count,
+                                                  alignment);
+    }
+
+    /// Bytes left in the chunk (not counting alignment).
+    s64 remaining() const {
+        const internal::dballoc::DbArenaHeader *info =
+                allocator_.currentBlock();
+        return info->size - info->offset;
+    }
+
+ private:
+    // The chunk is formatted as a small (fixed) arena of its own
+    static void *Reserve(void *arena, size_t bytes) {
+        typedef internal::dballoc::DatablockAllocator Allocator;
+        const size_t size = sizeof(internal::dballoc::DbArenaHeader) +
+                            Allocator::alignOffset(bytes, 16);
+        void *chunk = Allocator(arena).allocate(size, 1, 16);
+        internal::dballoc::AllocatorDbInit(chunk, size);
+        return chunk;
+    }
+
+    const internal::dballoc::DatablockAllocator allocator_;
+
+    friend class ArenaScope;
+};
+
+/**
+ * Scoped change to the implicit arena (see SetImplicitArena).
+ *
+ * An ArenaScope either makes another arena the implicit arena, or takes a
+ * checkpoint of the current implicit arena. Either way, the previous
+ * implicit arena is restored when the scope exits, so library code can
+ * allocate in its own arena without clobbering its caller's.
+ *
+ * A checkpoint also discards everything allocated in the implicit arena
+ * during the scope, so temporary allocations (e.g., for each iteration of
+ * a loop) cost just a pointer bump:
+ *
+ *     for (u32 i = 0; i < n; i++) {
+ *         ocxxr::ArenaScope scratch;
+ *         double *tmp = ocxxr::NewArray<double>(m);
+ *         ...
+ *     }  // the space used by tmp is reclaimed here
+ *
+ * Rolling back an ArenaMode::kFreeList arena also forgets the memory freed
+ * in its current datablock.
+ */
+class ArenaScope {
+ public:
+    /// Checkpoint the current implicit arena.
+    ArenaScope()
+            : saved_(internal::dballoc::AllocatorGet()),
+              checkpoint_(saved_.saveState()),
+              rollback_(true) {}
+
+    /// Use the given arena as the implicit arena within this scope.
+    template <typename T>
+    explicit ArenaScope(Arena<T> arena)
+            : saved_(internal::dballoc::AllocatorGet()),
+              checkpoint_(),
+              rollback_(false) {
+        SetImplicitArena(arena);
+    }
+
+    /// Allocate from the given chunk within this scope.
+    explicit ArenaScope(const ArenaChunk &chunk)
+            : saved_(internal::dballoc::AllocatorGet()),
+              checkpoint_(),
+              rollback_(false) {
+        internal::dballoc::AllocatorSet(chunk.allocator_);
+    }
+
+    ~ArenaScope() {
+        internal::dballoc::AllocatorSet(saved_);
+        if (rollback_) {
+            saved_.restoreState(checkpoint_);
+        }
+    }
+
+    ArenaScope(const ArenaScope &) = delete;
+
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+ private:
+    const internal::dballoc::DatablockAllocator saved_;
+    const internal::dballoc::AllocatorState checkpoint_;
+    const bool rollback_;
+};
+
 namespace internal {
 
 template <typename T>
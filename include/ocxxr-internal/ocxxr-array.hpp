@@ -0,0 +1,277 @@
+#ifndef OCXXR_ARRAY_HPP_
+#define OCXXR_ARRAY_HPP_
+/// @file
+
+namespace ocxxr {
+
+/// @brief A range of element indices [begin, end) in an ArrayDatablock.
+///
+/// This is trivially copyable, so it can be passed as a task's parameter
+/// to tell a child task which part of an array it owns.
+struct ArrayRange {
+    u64 begin;
+    u64 end;
+
+    u64 size() const { return end - begin; }
+
+    bool empty() const { return begin == end; }
+
+    /// @brief The index-th of `parts` nearly equal, disjoint subranges.
+    ///
+    /// The sizes of the parts differ by at most one element, and together
+    /// they cover the whole range in order.
+    ArrayRange Part(u64 parts, u64 index) const {
+        ASSERT(index < parts);
+        return {begin + size() * index / parts,
+                begin + size() * (index + 1) / parts};
+    }
+};
+
+/// @brief Header of an ArrayDatablock, followed by its elements.
+///
+/// The header is padded to the element type's alignment, so the elements
+/// start right after it.
+template <typename T>
+struct ArrayState {
+    static constexpr size_t kAlignment =
+            alignof(T) > alignof(u64) ? alignof(T) : alignof(u64);
+
+    alignas(kAlignment) u64 count;
+
+    T *elements() { return reinterpret_cast<T *>(this + 1); }
+};
+
+/// Handle for an OCR datablock holding an array (see ArrayDatablock).
+template <typename T>
+class ArrayDatablockHandle : public DatablockHandle<ArrayState<T>> {
+ public:
+    explicit ArrayDatablockHandle(ocrGuid_t guid = NULL_GUID)
+            : DatablockHandle<ArrayState<T>>(guid) {}
+
+    ArrayDatablockHandle(ArrayState<T> **data_ptr, u64 count,
+                         const DatablockHint *hint)
+            : DatablockHandle<ArrayState<T>>(
+                      DatablockHandle<ArrayState<T>>::Init(
+                              data_ptr,
+                              sizeof(ArrayState<T>) + sizeof(T) * count, true,
+                              hint)) {
+        (*data_ptr)->count = count;
+    }
+};
+
+static_assert(internal::IsLegalHandle<ArrayDatablockHandle<int>>::value,
+              "ArrayDatablockHandle must be castable to/from ocrGuid_t.");
+
+template <typename T>
+class ArrayPartition;
+
+/**
+ * A contiguous range of elements within an acquired ArrayDatablock.
+ *
+ * A slice is only a view: it doesn't own or copy its elements, and is only
+ * valid while the datablock is acquired. To hand a slice to a child task,
+ * pass its range() as the task's parameter along with the datablock, and
+ * recover the slice in the child with ArrayDatablock#Slice.
+ */
+template <typename T>
+class ArraySlice {
+ public:
+    typedef T value_type;
+    typedef T *iterator;
+
+    ArraySlice(ArrayDatablockHandle<T> handle, T *elements, ArrayRange range)
+            : handle_(handle), data_(elements + range.begin), range_(range) {}
+
+    /// Number of elements in this slice.
+    u64 size() const { return range_.size(); }
+
+    bool empty() const { return range_.empty(); }
+
+    /// Pointer to the first element of this slice.
+    T *data() const { return data_; }
+
+    T *begin() const { return data_; }
+
+    T *end() const { return data_ + size(); }
+
+    /// @brief Access an element of the slice.
+    /// @param[in] index Index relative to the start of the slice.
+    T &operator[](u64 index) const {
+        ASSERT(index < size());
+        return data_[index];
+    }
+
+    /// This slice's position in the whole array.
+    ArrayRange range() const { return range_; }
+
+    /// Handle of the datablock containing the whole array.
+    ArrayDatablockHandle<T> handle() const { return handle_; }
+
+    /// @brief A sub-slice of this slice.
+    /// @param[in] begin Index (relative to this slice) of the first element.
+    /// @param[in] end Index (relative to this slice) one past the last.
+    ArraySlice<T> Slice(u64 begin, u64 end) const {
+        ASSERT(begin <= end && end <= size());
+        return ArraySlice<T>(handle_, data_ - range_.begin,
+                             {range_.begin + begin, range_.begin + end});
+    }
+
+    /// Split this slice into `parts` nearly equal, disjoint slices.
+    ArrayPartition<T> Partition(u64 parts) const {
+        return ArrayPartition<T>(*this, parts);
+    }
+
+ private:
+    ArrayDatablockHandle<T> handle_;
+    T *data_;
+    ArrayRange range_;
+};
+
+/// @brief A slice split into nearly equal, disjoint parts.
+///
+/// The parts are computed on demand, so partitioning doesn't allocate.
+/// @see ArrayRange#Part
+template <typename T>
+class ArrayPartition {
+ public:
+    ArrayPartition(const ArraySlice<T> &whole, u64 parts)
+            : whole_(whole), parts_(parts) {
+        ASSERT(parts > 0);
+    }
+
+    /// Number of parts.
+    u64 size() const { return parts_; }
+
+    /// The index-th part.
+    ArraySlice<T> operator[](u64 index) const {
+        const ArrayRange part = whole_.range().Part(parts_, index);
+        const u64 offset = whole_.range().begin;
+        return whole_.Slice(part.begin - offset, part.end - offset);
+    }
+
+ private:
+    ArraySlice<T> whole_;
+    u64 parts_;
+};
+
+/**
+ * An acquired datablock holding an array that knows its own length.
+ *
+ * The element count is stored in a small header (ArrayState) at the start
+ * of the datablock, so tasks that receive the datablock can iterate over
+ * it without being told its size separately. Slice and Partition give
+ * zero-copy views of parts of the array, which lets several child tasks
+ * work on disjoint ranges of one large datablock:
+ *
+ *     void ScaleTask(ocxxr::ArrayRange range,
+ *                    ocxxr::ArrayDatablock<double> array) {
+ *         for (double &x : array.Slice(range)) x *= 2;
+ *     }
+ *
+ *     auto parts = array.Partition(4);
+ *     for (u64 i = 0; i < parts.size(); i++) {
+ *         scale_template().CreateTask(parts[i].range(), array);
+ *     }
+ *
+ * The elements aren't constructed (as with Datablock), so `T` should be a
+ * trivial type. The runtime doesn't check that the children's ranges are
+ * disjoint; that is up to the caller.
+ */
+template <typename T>
+class ArrayDatablock : public AcquiredData {
+ public:
+    typedef T value_type;
+    typedef T *iterator;
+
+    // default constructor: creates null datablock
+    explicit ArrayDatablock(std::nullptr_t np = nullptr)
+            : handle_(NULL_GUID), state_(np) {}
+
+    // this constructor gets called from the task setup code
+    // (which registers all of the task's dependences in bulk)
+    explicit ArrayDatablock(ocrEdtDep_t dep)
+            : handle_(dep.guid),
+              state_(static_cast<ArrayState<T> *>(dep.ptr)) {}
+
+    /// @brief Create and acquire an array datablock.
+    /// @param[in] count Number of elements of type `T` in the array.
+    static ArrayDatablock<T> Create(u64 count) {
+        return ArrayDatablock<T>(nullptr, count, nullptr);
+    }
+
+    /// Number of elements in the array.
+    u64 size() const { return state_->count; }
+
+    bool empty() const { return size() == 0; }
+
+    /// Pointer to the first element.
+    T *data() const { return state_->elements(); }
+
+    T *begin() const { return data(); }
+
+    T *end() const { return data() + size(); }
+
+    T &operator[](u64 index) const {
+        ASSERT(index < size());
+        return data()[index];
+    }
+
+    /// @brief A view of the elements [begin, end).
+    ArraySlice<T> Slice(u64 begin, u64 end) const {
+        return Slice({begin, end});
+    }
+
+    /// @brief A view of a range of elements (e.g., a child task's range).
+    ArraySlice<T> Slice(ArrayRange range) const {
+        ASSERT(range.begin <= range.end && range.end <= size());
+        return ArraySlice<T>(handle_, data(), range);
+    }
+
+    /// A view of the whole array.
+    ArraySlice<T> All() const { return Slice(0, size()); }
+
+    /// Split the array into `parts` nearly equal, disjoint slices.
+    ArrayPartition<T> Partition(u64 parts) const {
+        return All().Partition(parts);
+    }
+
+    /// Get the datablock's current base address pointer.
+    ArrayState<T> *base_ptr() const { return state_; }
+
+    /// Null datablock predicate.
+    bool is_null() const { return state_ == nullptr; }
+
+    /// Get this datablock's global handle.
+    ArrayDatablockHandle<T> handle() const { return handle_; }
+
+    /// Release the datablock (see Datablock#Release).
+    void Release() const {
+        internal::OK(ocrDbRelease(handle_.guid()));
+        internal::bookkeeping::RemoveDatablock(handle_.guid());
+    }
+
+    /// Destroy this datablock.
+    void Destroy() const { handle_.Destroy(); }
+
+    // automatic type conversion to ArrayDatablockHandle
+    operator ArrayDatablockHandle<T>() const { return handle_; }
+
+ private:
+    ArrayDatablock(ArrayState<T> *tmp, u64 count, const DatablockHint *hint)
+            : handle_(&tmp, count, hint), state_(tmp) {}
+
+    ArrayDatablockHandle<T> handle_;
+    ArrayState<T> *state_;
+};
+
+namespace internal {
+
+template <typename T>
+struct Unpack<ArrayDatablock<T>> {
+    typedef ArrayState<T> Parameter;
+};
+
+}  // namespace internal
+}  // namespace ocxxr
+
+#endif  // OCXXR_ARRAY_HPP_
@@ -0,0 +1,324 @@
+#ifndef OCXXR_COMPACT_HPP_
+#define OCXXR_COMPACT_HPP_
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace ocxxr {
+
+/**
+ * Traversal trait listing the pointer fields of a type.
+ *
+ * Operations that need to follow the object graph in an arena (e.g.,
+ * Arena#Compact) use this trait to find the pointers in each object.
+ * Specialize it for every arena-allocated type that contains RelPtr,
+ * BasedPtr or CompactBasedPtr fields, passing each field to the visitor.
+ * If a field points to an array, also pass the number of elements (and,
+ * if only some of them are initialized, the number of initialized
+ * elements):
+ *
+ *     template <>
+ *     struct PointerFields<Node> {
+ *         template <typename V>
+ *         static void Visit(Node &node, V &visitor) {
+ *             visitor(node.next);
+ *             visitor(node.values, node.value_count);
+ *         }
+ *     };
+ *
+ * Pointers must point to the start of an object (or array of objects).
+ * The default (unspecialized) trait has no pointer fields.
+ */
+template <typename T>
+struct PointerFields {
+    template <typename V>
+    static void Visit(T &, V &) {}
+};
+
+/// An array of relative pointers: the element itself is the pointer field.
+template <typename T, typename OffsetT>
+struct PointerFields<RelPtr<T, OffsetT>> {
+    template <typename V>
+    static void Visit(RelPtr<T, OffsetT> &ptr, V &visitor) {
+        visitor(ptr);
+    }
+};
+
+/// An array of based pointers: the element itself is the pointer field.
+template <typename T>
+struct PointerFields<BasedPtr<T>> {
+    template <typename V>
+    static void Visit(BasedPtr<T> &ptr, V &visitor) {
+        visitor(ptr);
+    }
+};
+
+/// An array of compact based pointers: the element itself is the pointer.
+template <typename T>
+struct PointerFields<CompactBasedPtr<T>> {
+    template <typename V>
+    static void Visit(CompactBasedPtr<T> &ptr, V &visitor) {
+        visitor(ptr);
+    }
+};
+
+namespace internal {
+namespace dballoc {
+
+/**
+ * Copies the object graph reachable from an arena's root into a new,
+ * exactly-sized arena datablock.
+ *
+ * Works in three passes over the graph, all driven by PointerFields:
+ * discovering the live objects (and giving each one a new offset),
+ * copying them, and then updating each copied pointer to the new
+ * location of its target. Pointers are updated by assignment, so
+ * RelPtr, BasedPtr and CompactBasedPtr fields all end up in the correct
+ * form. (CompactBasedPtrs are read through the old arena's GUID table, and
+ * written through the new arena's, so the implicit arena is switched to
+ * each in turn.)
+ */
+class ArenaCompactor {
+ public:
+    explicit ArenaCompactor(DbArenaHeader *head)
+            : mode_(kDiscover),
+              size_(0),
+              next_target_(0),
+              source_(head),
+              new_base_(nullptr) {
+        // Remember the address ranges of every datablock in the arena
+        DbArenaHeader *block = head;
+        for (;;) {
+            const char *base = reinterpret_cast<const char *>(block);
+            ranges_.push_back({base, base + block->size});
+            if (ocrGuidIsNull(block->next)) break;
+            block = ArenaBlockForGuid(block->next);
+        }
+    }
+
+    /// Start the traversal from the arena root.
+    template <typename T>
+    void Discover(T *root) {
+        const DatablockAllocator saved = AllocatorGet();
+        AllocatorSetDb(source_);
+        Record(root, 1, 1, sizeof(T), alignof(T), &VisitObjects<T>);
+        while (!worklist_.empty()) {
+            const size_t index = worklist_.back();
+            worklist_.pop_back();
+            // (copied, since visiting can add more objects)
+            const Object object = objects_[index];
+            object.visit(const_cast<void *>(object.old_addr), object.live,
+                         *this);
+        }
+        AllocatorSet(saved);
+    }
+
+    /// @brief Bytes needed for the live objects (including the arena header).
+    ///
+    /// Includes room for aligning over-aligned objects, wherever the new
+    /// datablock ends up.
+    size_t LayOut() {
+        int max_alignment = 16;
+        for (const Object &object : objects_) {
+            max_alignment = std::max(max_alignment, object.alignment);
+        }
+        return Place(nullptr) + (max_alignment - 16);
+    }
+
+    /// Copy the live objects into a new (initialized) arena datablock.
+    void CopyTo(DbArenaHeader *target) {
+        new_base_ = reinterpret_cast<char *>(target);
+        size_ = Place(new_base_);
+        for (const Object &object : objects_) {
+            std::memcpy(new_base_ + object.new_offset, object.old_addr,
+                        object.elem_size * object.count);
+        }
+        const DatablockAllocator saved = AllocatorGet();
+        // read the pointers from the originals...
+        AllocatorSetDb(source_);
+        mode_ = kCollect;
+        for (const Object &object : objects_) {
+            object.visit(const_cast<void *>(object.old_addr), object.live,
+                         *this);
+        }
+        // ...and write the updated pointers into the copies
+        AllocatorSetDb(target);
+        mode_ = kUpdate;
+        next_target_ = 0;
+        for (const Object &object : objects_) {
+            object.visit(new_base_ + object.new_offset, object.live, *this);
+        }
+        AllocatorSet(saved);
+        assert(static_cast<ptrdiff_t>(size_) <= AllocatorDbLimit(target) &&
+               "Compacted arena is too small");
+        target->offset = size_;
+        AllocatorDbUpdateStats(target);
+    }
+
+    template <typename U, typename OffsetT>
+    void operator()(const RelPtr<U, OffsetT> &ptr, size_t count = 1,
+                    size_t live = kAll) {
+        Edge(const_cast<RelPtr<U, OffsetT> &>(ptr), count,
+             std::min(live, count), true);
+    }
+
+    template <typename U>
+    void operator()(const BasedPtr<U> &ptr, size_t count = 1,
+                    size_t live = kAll) {
+        Edge(const_cast<BasedPtr<U> &>(ptr), count, std::min(live, count),
+             false);
+    }
+
+    template <typename U>
+    void operator()(const CompactBasedPtr<U> &ptr, size_t count = 1,
+                    size_t live = kAll) {
+        Edge(const_cast<CompactBasedPtr<U> &>(ptr), count,
+             std::min(live, count), false);
+    }
+
+ private:
+    typedef void (*VisitFn)(void *objects, size_t count, ArenaCompactor &);
+
+    enum Mode { kDiscover, kCollect, kUpdate };
+
+    static constexpr size_t kAll = ~static_cast<size_t>(0);
+
+    struct Object {
+        const void *old_addr;
+        size_t count;  // elements to copy
+        size_t live;   // initialized elements (to visit)
+        size_t elem_size;
+        int alignment;
+        ptrdiff_t new_offset;
+        VisitFn visit;
+    };
+
+    struct Range {
+        const char *start;
+        const char *end;
+    };
+
+    template <typename U>
+    static void VisitObjects(void *objects, size_t count, ArenaCompactor &c) {
+        typedef typename std::remove_const<U>::type V;
+        V *array = static_cast<V *>(objects);
+        for (size_t i = 0; i < count; i++) {
+            PointerFields<V>::Visit(array[i], c);
+        }
+    }
+
+    template <typename P, typename U = typename std::remove_reference<
+                                  decltype(*std::declval<P>())>::type>
+    void Edge(P &ptr, size_t count, size_t live, bool must_be_in_arena) {
+        static_cast<void>(must_be_in_arena);  // unused if asserts are disabled
+        switch (mode_) {
+            case kDiscover: {
+                U *target = ptr;
+                if (!target) break;
+                if (!InArena(target)) {
+                    ASSERT(!must_be_in_arena &&
+                           "Relative pointer points outside of the arena");
+                    break;
+                }
+                Record(target, count, live, sizeof(U), alignof(U),
+                       &VisitObjects<U>);
+                break;
+            }
+            case kCollect: {
+                U *target = ptr;
+                targets_.push_back(target);
+                break;
+            }
+            case kUpdate: {
+                const void *target = targets_[next_target_++];
+                ptr = static_cast<U *>(const_cast<void *>(Forward(target)));
+                break;
+            }
+        }
+    }
+
+    // Give each object an offset in a datablock at the given address
+    size_t Place(const char *base) {
+        ptrdiff_t offset = sizeof(DbArenaHeader);
+        for (Object &object : objects_) {
+            offset = DatablockAllocator::alignStart(base, offset,
+                                                    object.alignment);
+            object.new_offset = offset;
+            offset += object.elem_size * object.count;
+        }
+        return offset;
+    }
+
+    void Record(const void *addr, size_t count, size_t live,
+                size_t elem_size, size_t alignment, VisitFn visit) {
+        auto found = index_.find(addr);
+        if (found == index_.end()) {
+            index_[addr] = objects_.size();
+            worklist_.push_back(objects_.size());
+            const int object_alignment =
+                    DatablockAllocator::alignmentFor(elem_size, alignment);
+            objects_.push_back({addr, count, live, elem_size,
+                                object_alignment, 0, visit});
+        } else {
+            Object &object = objects_[found->second];
+            if (object.count < count || object.live < live) {
+                // need to copy (or visit) the extra elements too
+                ASSERT(object.elem_size == elem_size &&
+                       "Arena object referenced with two different types");
+                object.count = std::max(object.count, count);
+                object.live = std::max(object.live, live);
+                worklist_.push_back(found->second);
+            }
+        }
+    }
+
+    bool InArena(const void *addr) const {
+        const char *p = static_cast<const char *>(addr);
+        for (const Range &range : ranges_) {
+            if (range.start <= p && p < range.end) return true;
+        }
+        return false;
+    }
+
+    // New address for a pointer target (unchanged if not in the arena)
+    const void *Forward(const void *target) const {
+        if (!target) return nullptr;
+        auto found = index_.find(target);
+        if (found == index_.end()) return target;
+        return new_base_ + objects_[found->second].new_offset;
+    }
+
+    Mode mode_;
+    size_t size_;
+    std::vector<Range> ranges_;
+    std::vector<Object> objects_;
+    std::unordered_map<const void *, size_t> index_;
+    std::vector<size_t> worklist_;
+    std::vector<const void *> targets_;
+    size_t next_target_;
+    DbArenaHeader *const source_;
+    char *new_base_;
+};
+
+}  // namespace dballoc
+}  // namespace internal
+
+template <typename T>
+Arena<T> Arena<T>::Compact() const {
+    static_assert(!internal::IsVoid<T>::Value,
+                  "Compacting an arena requires a root object type.");
+    internal::dballoc::ArenaCompactor compactor(&state_->header);
+    compactor.Discover(data_ptr());
+    const size_t bytes = compactor.LayOut();
+    // (everything ends up in one datablock, so the result isn't chained)
+    const u32 mode = state_->header.mode & ~ArenaMode::kChained;
+    Arena<T> result(nullptr, bytes - sizeof(ArenaState<T>), nullptr, mode);
+    compactor.CopyTo(&result.state_->header);
+    return result;
+}
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_COMPACT_HPP_
@@ -3,8 +3,16 @@
 /// @file
 
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iterator>
 
+// Task parameters bigger than this (in bytes) are passed in a datablock
+// instead of being copied into the task's paramv (see SpillTaskParam)
+#ifndef OCXXR_PARAM_SPILL_BYTES
+#define OCXXR_PARAM_SPILL_BYTES 256
+#endif
+
 namespace ocxxr {
 
 /// @brief Base class for all OCR objects which can carry data.
@@ -62,8 +70,19 @@ class NullHandle : public ObjectHandle {
 static_assert(internal::IsLegalHandle<NullHandle>::value,
               "NullHandle must be castable to/from ocrGuid_t.");
 
-/// Shut down OCR.
-inline void Shutdown() { ocrShutdown(); }
+// defined in ocxxr-arena.hpp
+inline void PrintArenaStats();
+
+/// @brief Shut down OCR.
+///
+/// If OCXXR_ARENA_STATS is defined, this also prints the arena statistics
+/// (see PrintArenaStats).
+inline void Shutdown() {
+#ifdef OCXXR_ARENA_STATS
+    PrintArenaStats();
+#endif
+    ocrShutdown();
+}
 
 /// Abort OCR execution with an error code.
 inline void Abort(u8 error_code) { ocrAbort(error_code); }
@@ -90,13 +109,13 @@ class DatablockHandle : public DataHandle<T> {
 
  protected:
     explicit DatablockHandle(u64 count)
-            : DataHandle<T>(Init(sizeof(T) * count, false, nullptr)) {}
+            : DataHandle<T>(Init(sizeof(T) * count, nullptr)) {}
 
     DatablockHandle(u64 count, const DatablockHint &hint)
-            : DataHandle<T>(Init(sizeof(T) * count, false, &hint)) {}
+            : DataHandle<T>(Init(sizeof(T) * count, &hint)) {}
 
     static ocrGuid_t Init(u64 bytes, const DatablockHint *hint) {
-        T **data_ptr;
+        T *data_ptr;
         return Init(&data_ptr, bytes, false, hint);
     }
 
@@ -136,9 +155,22 @@ class Datablock : public AcquiredData {
             : handle_(NULL_GUID), data_(np) {}
 
     // this constructor gets called from the task setup code
+    // (which registers all of the task's dependences in bulk)
     explicit Datablock(ocrEdtDep_t dep)
-            : handle_(dep.guid), data_(static_cast<T *>(dep.ptr)) {
-        internal::bookkeeping::AddDatablock(dep.guid, dep.ptr);
+            : handle_(dep.guid), data_(static_cast<T *>(dep.ptr)) {}
+
+    // View one of a task's dependences in place as a Datablock
+    static Datablock *FromDep(ocrEdtDep_t *dep) {
+        // ocrEdtDep_t may have more fields (e.g., the access mode),
+        // but it must start with the same fields as a Datablock
+        static_assert(std::is_standard_layout<Datablock>::value &&
+                              sizeof(Datablock) <= sizeof(ocrEdtDep_t) &&
+                              offsetof(Datablock, handle_) ==
+                                      offsetof(ocrEdtDep_t, guid) &&
+                              offsetof(Datablock, data_) ==
+                                      offsetof(ocrEdtDep_t, ptr),
+                      "Datablock must have the same layout as ocrEdtDep_t.");
+        return reinterpret_cast<Datablock *>(dep);
     }
 
     /// @brief Create and acquire a datablock.
@@ -208,37 +240,164 @@ class DataHandleList {
     // FIXME - implement!
 };
 
+/// @brief A list of acquired datablocks (e.g., a task's VarArgs).
+///
+/// The default variant (`DatablockList<T>`) either allocates its storage
+/// on the heap, or (for a task's VarArgs) is a view directly over the
+/// task's dependence vector. `DatablockList<T, N>` has a fixed capacity
+/// and keeps its storage inline, so it can live on the stack.
+template <typename T, size_t N = 0>
+class DatablockList;
+
+namespace internal {
+
+// Read-only iterator over Datablocks stored at a fixed stride
+// (which is larger than a Datablock when viewing a task's depv array,
+// which the runtime still owns, so it mustn't be reordered or overwritten)
+template <typename T>
+class DatablockIterator {
+ public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef Datablock<T> value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const Datablock<T> *pointer;
+    typedef const Datablock<T> &reference;
+
+    DatablockIterator(const char *position, size_t stride)
+            : position_(position), stride_(stride) {}
+
+    reference operator*() const {
+        return *reinterpret_cast<pointer>(position_);
+    }
+
+    pointer operator->() const { return reinterpret_cast<pointer>(position_); }
+
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    DatablockIterator &operator+=(difference_type n) {
+        position_ += n * static_cast<difference_type>(stride_);
+        return *this;
+    }
+
+    DatablockIterator &operator-=(difference_type n) { return *this += -n; }
+
+    DatablockIterator &operator++() { return *this += 1; }
+
+    DatablockIterator &operator--() { return *this -= 1; }
+
+    DatablockIterator operator++(int) {
+        DatablockIterator old = *this;
+        *this += 1;
+        return old;
+    }
+
+    DatablockIterator operator--(int) {
+        DatablockIterator old = *this;
+        *this -= 1;
+        return old;
+    }
+
+    DatablockIterator operator+(difference_type n) const {
+        return DatablockIterator(*this) += n;
+    }
+
+    DatablockIterator operator-(difference_type n) const {
+        return DatablockIterator(*this) -= n;
+    }
+
+    difference_type operator-(const DatablockIterator &other) const {
+        return (position_ - other.position_) /
+               static_cast<difference_type>(stride_);
+    }
+
+    bool operator==(const DatablockIterator &other) const {
+        return position_ == other.position_;
+    }
+
+    bool operator!=(const DatablockIterator &other) const {
+        return position_ != other.position_;
+    }
+
+    bool operator<(const DatablockIterator &other) const {
+        return position_ < other.position_;
+    }
+
+    bool operator>(const DatablockIterator &other) const {
+        return other < *this;
+    }
+
+    bool operator<=(const DatablockIterator &other) const {
+        return !(other < *this);
+    }
+
+    bool operator>=(const DatablockIterator &other) const {
+        return !(*this < other);
+    }
+
+ private:
+    const char *position_;
+    size_t stride_;
+};
+
+template <typename T>
+DatablockIterator<T> operator+(ptrdiff_t n, const DatablockIterator<T> &it) {
+    return it + n;
+}
+
+}  // namespace internal
+
 template <typename T>
-class DatablockList : public AcquiredData {
+class DatablockList<T, 0> : public AcquiredData {
  public:
+    typedef internal::DatablockIterator<T> Iterator;
+
     // FIXME - define move assignment function.
     DatablockList(size_t size)
             : capacity_(size),
               count_(0),
-              data_(size ? OCXXR_TEMP_ARRAY_NEW(Datablock<T>, size) : nullptr) {
-    }
+              data_(size ? Bytes(OCXXR_TEMP_ARRAY_NEW(Datablock<T>, size))
+                         : nullptr),
+              stride_(sizeof(Datablock<T>)),
+              owns_data_(true) {}
+
+    // this constructor gets called from the task setup code
+    // (creates a view over the task's dependences, with no copying)
+    DatablockList(ocrEdtDep_t deps[], size_t count)
+            : capacity_(count),
+              count_(count),
+              data_(Bytes(Datablock<T>::FromDep(deps))),
+              stride_(sizeof(ocrEdtDep_t)),
+              owns_data_(false) {}
 
     DatablockList(DatablockList &&other)
             : capacity_(other.capacity_),
               count_(other.count_),
-              data_(other.data_) {
+              data_(other.data_),
+              stride_(other.stride_),
+              owns_data_(other.owns_data_) {
         other.data_ = nullptr;
     }
 
-    ~DatablockList() { OCXXR_TEMP_ARRAY_DELETE(data_); }
+    ~DatablockList() {
+        if (owns_data_) {
+            OCXXR_TEMP_ARRAY_DELETE(reinterpret_cast<Datablock<T> *>(data_));
+        }
+    }
 
-    Datablock<T> *begin() const { return data_; }
+    Iterator begin() const { return Iterator(data_, stride_); }
 
-    Datablock<T> *end() const { return data_ + count_; }
+    Iterator end() const { return Iterator(data_ + count_ * stride_, stride_); }
 
-    Datablock<T> &operator[](size_t index) const {
+    const Datablock<T> &operator[](size_t index) const {
         ASSERT(index < capacity_);
-        return data_[index];
+        return *reinterpret_cast<const Datablock<T> *>(data_ +
+                                                       index * stride_);
     }
 
     DatablockList &Add(Datablock<T> datablock) {
         ASSERT(count_ < capacity_ && "DatablockList overflow!");
-        *end() = datablock;
+        *reinterpret_cast<Datablock<T> *>(data_ + count_ * stride_) =
+                datablock;
         ++count_;
         return *this;
     }
@@ -247,10 +406,44 @@ class DatablockList : public AcquiredData {
 
     size_t count() const { return count_; };
 
+ protected:
+    // for lists with externally-managed storage
+    DatablockList(Datablock<T> *storage, size_t capacity)
+            : capacity_(capacity),
+              count_(0),
+              data_(Bytes(storage)),
+              stride_(sizeof(Datablock<T>)),
+              owns_data_(false) {}
+
  private:
+    static char *Bytes(Datablock<T> *datablocks) {
+        return reinterpret_cast<char *>(datablocks);
+    }
+
     size_t capacity_;
     size_t count_;
-    Datablock<T> *data_;
+    char *data_;
+    size_t stride_;
+    bool owns_data_;
+};
+
+/// @brief A fixed-capacity list of acquired datablocks.
+///
+/// The storage is part of the object, so a list declared as a local
+/// variable does no heap allocation. It can be used anywhere a
+/// `DatablockList<T>` is expected (e.g., when creating a task with VarArgs),
+/// but cannot be copied or moved.
+template <typename T, size_t N>
+class DatablockList : public DatablockList<T> {
+ public:
+    DatablockList() : DatablockList<T>(storage_, N) {}
+
+    DatablockList(const DatablockList &) = delete;
+
+    DatablockList &operator=(const DatablockList &) = delete;
+
+ private:
+    Datablock<T> storage_[N];
 };
 
 struct Properties {
@@ -436,6 +629,44 @@ class UnknownDependence : public DataHandle<T> {
 static_assert(internal::IsLegalHandle<UnknownDependence<int>>::value,
               "UnknownDependence must be castable to/from ocrGuid_t.");
 
+/// @brief Default policy for task templates.
+///
+/// Tasks track which datablocks they have acquired, which is needed for
+/// creating or dereferencing a BasedPtr. Custom policies should derive
+/// from this one and override only the settings they need to change.
+/// @see TaskTemplate#Create
+struct DefaultTaskPolicy {
+    /// Maintain the task's acquired-datablock bookkeeping
+    static constexpr bool kTrackDatablocks = true;
+    /// Cache recent BasedPtr resolutions (only useful with tracking)
+    static constexpr bool kCacheLookups = true;
+};
+
+/// @brief Task template policy that skips datablock bookkeeping.
+///
+/// Saves the cost of tracking acquired datablocks in tasks that never
+/// create or dereference a BasedPtr. Using a BasedPtr in such a task
+/// is an error (caught by an assertion in debug builds).
+struct UntrackedTaskPolicy : DefaultTaskPolicy {
+    /// Maintain the task's acquired-datablock bookkeeping
+    static constexpr bool kTrackDatablocks = false;
+};
+
+/**
+ * Decides whether a task parameter of type T is spilled into a datablock.
+ *
+ * Small parameters are copied inline into each task's paramv. A parameter
+ * bigger than OCXXR_PARAM_SPILL_BYTES is instead copied into a datablock
+ * of its own, which is passed to the task as a hidden read-only dependence
+ * (after the task's other dependences, and before its VarArgs) and
+ * destroyed when the task finishes. This is transparent to the task
+ * function. Specialize this trait to choose differently for a type.
+ */
+template <typename T>
+struct SpillTaskParam {
+    static constexpr bool value = sizeof(T) > OCXXR_PARAM_SPILL_BYTES;
+};
+
 namespace internal {
 
 template <typename T>
@@ -558,9 +789,12 @@ struct TaskParamInfo {
     typedef typename TaskArgInfo<F>::Type Type;
     typedef typename std::remove_reference<Type>::type RawType;
     static constexpr size_t kParamBytes = sizeof(RawType);
-    // count of just the parameter object words
+    static constexpr bool kSpilled = SpillTaskParam<RawType>::value;
+    // count of just the parameter object words (none if spilled)
     static constexpr size_t kParamWordCount =
-            (kParamBytes + sizeof(u64) - 1) / sizeof(u64);
+            kSpilled ? 0 : (kParamBytes + sizeof(u64) - 1) / sizeof(u64);
+    // count of hidden dependences (for the spilled parameter)
+    static constexpr size_t kSpillDepc = kSpilled ? 1 : 0;
     // This is going to get memcpy'd
     static_assert(IsTriviallyCopyable<RawType>::value,
                   "Task parameter must be trivially copyable.");
@@ -571,8 +805,10 @@ struct TaskParamInfo<F, false> {
     typedef void Type;
     typedef void RawType;
     static constexpr size_t kParamBytes = 0;
+    static constexpr bool kSpilled = false;
     // count of just the parameter object words
     static constexpr size_t kParamWordCount = 0;
+    static constexpr size_t kSpillDepc = 0;
 };
 
 template <typename F>
@@ -602,18 +838,22 @@ struct TaskArgTypeMatchesParamType {
     static constexpr bool value = true;
 };
 
-template <typename T, T *t, typename U, typename V, typename W>
+template <typename T, T *t, typename U, typename V, typename W,
+          typename Policy>
 class TaskImplementation;
 
 // TODO - add static check to make sure Args have Datablock types
 template <typename F, F *user_fn, typename... Params, typename... Args,
-          typename... VarArgs>
+          typename... VarArgs, typename Policy>
 class TaskImplementation<F, user_fn, void(Params...), void(Args...),
-                         void(VarArgs...)> {
+                         void(VarArgs...), Policy> {
  public:
     static constexpr size_t kDepc = internal::FnInfo<F>::kDepCount;
     static constexpr size_t kParamc = internal::FnInfo<F>::kParamCount;
     static constexpr size_t kVarArgc = sizeof...(VarArgs);
+    static constexpr bool kSpilled = internal::TaskParamInfo<F>::kSpilled;
+    // the spilled parameter's slot comes right after the other dependences
+    static constexpr size_t kSpillDepc = internal::TaskParamInfo<F>::kSpillDepc;
     typedef typename internal::FnInfo<F>::Result R;
 
     static_assert(std::is_same<F, R(Params..., Args..., VarArgs...)>::value,
@@ -622,10 +862,16 @@ class TaskImplementation<F, user_fn, void(Params...), void(Args...),
     static ocrGuid_t InternalFn(u32 paramc, u64 paramv[], u32 depc,
                                 ocrEdtDep_t depv[]) {
         ASSERT(paramc == internal::TaskParamInfo<F>::kParamWordCount);
-        ASSERT(kVarArgc > 0 || depc == kDepc);
-        ASSERT(depc >= kDepc);
-        PushTaskState();
+        ASSERT(kVarArgc > 0 || depc == kDepc + kSpillDepc);
+        ASSERT(depc >= kDepc + kSpillDepc);
+        PushTaskState(Policy::kTrackDatablocks, Policy::kCacheLookups);
+        if (Policy::kTrackDatablocks) {
+            bookkeeping::DeferDatablocks(depc, depv);
+        }
         ocrGuid_t result = Launch(paramv, depc, depv);
+        if (kSpilled) {
+            internal::OK(ocrDbDestroy(depv[kDepc].guid));
+        }
         PopTaskState();
         return result;
     }
@@ -650,15 +896,15 @@ class TaskImplementation<F, user_fn, void(Params...), void(Args...),
     template <typename T = typename internal::FnInfo<F>::VarArgsType>
     static DatablockList<T> UnpackVarArgs(u32 depc, ocrEdtDep_t depv[],
                                           size_t) {
-        DatablockList<T> var_args(depc);
-        for (u32 i = kDepc; i < depc; i++) {
-            var_args.Add(Datablock<T>(depv[i]));
-        }
-        return std::move(var_args);
+        return DatablockList<T>(&depv[kDepc + kSpillDepc],
+                                depc - kDepc - kSpillDepc);
     }
 
     template <typename T, typename U = typename std::remove_reference<T>::type>
-    static U *UnpackParam(u64 *param) {
+    static U *UnpackParam(u64 *param, ocrEdtDep_t depv[]) {
+        if (kSpilled) {
+            return static_cast<U *>(depv[kDepc].ptr);
+        }
         return reinterpret_cast<U *>(param);
     }
 
@@ -670,7 +916,7 @@ class TaskImplementation<F, user_fn, void(Params...), void(Args...),
         static_cast<void>(paramv);  // unused if no parameters
         static_cast<void>(depc);    // unused if no deps
         static_cast<void>(depv);    // unused if no deps
-        return user_fn((*UnpackParam<Params>(&paramv[I]))...,
+        return user_fn((*UnpackParam<Params>(&paramv[I], depv))...,
                        (Args{depv[J]})..., (UnpackVarArgs(depc, depv, K))...);
     }
 };
@@ -726,6 +972,8 @@ class Task<Ret(Args...)> : public ObjectHandle {
 
     static constexpr size_t kDepc = internal::FnInfo<F>::kDepCount;
     static constexpr size_t kParamc = internal::FnInfo<F>::kParamCount;
+    // hidden dependence for a spilled parameter (see SpillTaskParam)
+    static constexpr size_t kSpillDepc = internal::TaskParamInfo<F>::kSpillDepc;
 
     void Destroy() const { internal::OK(ocrEdtDestroy(this->guid())); }
 
@@ -769,7 +1017,8 @@ class Task<Ret(Args...)> : public ObjectHandle {
         const ocrGuid_t task = this->guid();
         for (u32 j = 0; j < count; j++) {
             ocrGuid_t g = static_cast<DataHandle<U>>(src[j]).guid();
-            internal::OK(ocrAddDependence(g, task, slot + j, mode));
+            internal::OK(
+                    ocrAddDependence(g, task, slot + kSpillDepc + j, mode));
         }
         return *this;
     }
@@ -791,7 +1040,7 @@ class Task<Ret(Args...)> : public ObjectHandle {
         typedef typename i::FnInfo<F>::VarArgsType U;
         typedef DataHandle<U> Expected;
         typedef DataHandleOf<T> Actual;
-        const u32 slot = kDepc + index;
+        const u32 slot = kDepc + kSpillDepc + index;
         static_assert(i::FnInfo<F>::kHasVarArgs,
                       "Only use this function to add VarArgs list dependences");
         static_assert(
@@ -834,7 +1083,8 @@ class Task<Ret(Args...)> : public ObjectHandle {
                           const TaskHint *hint, u16 flags) {
         ocrGuid_t guid;
         ocrGuid_t *out_guid = reinterpret_cast<ocrGuid_t *>(out_event);
-        ASSERT(paramv != nullptr || kParamc == 0);
+        ASSERT(paramv != nullptr ||
+               internal::TaskParamInfo<F>::kParamWordCount == 0);
         // TODO - open bug for adding const qualifiers in OCR C API.
         // E.g., "const ocrHint_t *hint" in ocrEdtCreate.
         ocrHint_t *raw_hint = const_cast<ocrHint_t *>(hint->internal());
@@ -881,6 +1131,10 @@ class TaskBuilder<F, void(Params...), void(Args...), void(VarArgs...)> {
  public:
     static constexpr bool kHasVarArgs = sizeof...(VarArgs) > 0;
     static constexpr size_t kDepc = internal::FnInfo<F>::kDepCount;
+    static constexpr bool kSpilled = internal::TaskParamInfo<F>::kSpilled;
+    static constexpr size_t kSpillDepc = internal::TaskParamInfo<F>::kSpillDepc;
+    static constexpr size_t kParamWords =
+            internal::TaskParamInfo<F>::kParamWordCount;
     typedef typename internal::FnInfo<F>::Result Ret;
     static_assert(std::is_same<F, Ret(Params..., Args..., VarArgs...)>::value,
                   "Task function must have a consistent type.");
@@ -936,16 +1190,20 @@ class TaskBuilder<F, void(Params...), void(Args...), void(VarArgs...)> {
         ASSERT((!out_event || flags_ != EDT_PROP_FINISH) &&
                "Created Finish-type EDT, but not using the output event.");
         // Set params (if any)
-        u64 *param_ptr[1 + Task<F>::kParamc] = {
-                reinterpret_cast<u64 *>(&params)..., nullptr};
-        // Set provided dependences
-        constexpr u32 depc = kDepc;
+        u64 paramv[1 + kParamWords] = {};
+        PackParams(paramv, params...);
+        // Set provided dependences (the spilled parameter's slot, if any,
+        // is filled in by SpillParam)
+        constexpr u32 depc = kDepc + kSpillDepc;
         ocrGuid_t depv[1 + depc] = {
-                (static_cast<DataHandleOf<Args>>(deps).guid())..., NULL_GUID};
+                (static_cast<DataHandleOf<Args>>(deps).guid())...,
+                kSpilled ? UNINITIALIZED_GUID : NULL_GUID};
         ocrGuid_t *depv_ptr = depc > 0 ? depv : nullptr;
         // Create the task
-        return Task<F>(out_event, template_guid_, param_ptr[0], depc, depv_ptr,
-                       hint_, flags_);
+        auto task = Task<F>(out_event, template_guid_, ParamPtr(paramv),
+                            depc, depv_ptr, hint_, flags_);
+        SpillParam(task, params...);
+        return task;
     }
 
     template <typename T, bool kEnable = kHasVarArgs,
@@ -956,29 +1214,36 @@ class TaskBuilder<F, void(Params...), void(Args...), void(VarArgs...)> {
         ASSERT((!out_event || flags_ != EDT_PROP_FINISH) &&
                "Created Finish-type EDT, but not using the output event.");
         // Set params (if any)
-        u64 *param_ptr[1 + Task<F>::kParamc] = {
-                reinterpret_cast<u64 *>(&params)..., nullptr};
+        u64 paramv[1 + kParamWords] = {};
+        PackParams(paramv, params...);
         // Set provided dependences
         ASSERT(var_args.count() == var_args.capacity() &&
                "Used incomplete DatablockList for task creation");
-        const u32 depc = kDepc + var_args.capacity();
-        ocrGuid_t *depv;
-        if (depc > 0) {
+        const u32 depc = kDepc + kSpillDepc + var_args.capacity();
+        // only use the heap for very wide tasks
+        ocrGuid_t stack_depv[kStackDepc + 1];
+        ocrGuid_t *depv = nullptr;
+        if (depc > kStackDepc) {
             depv = OCXXR_TEMP_ARRAY_NEW(ocrGuid_t, depc + 1);
+        } else if (depc > 0) {
+            depv = stack_depv;
+        }
+        if (depc > 0) {
             ::new (depv) ocrGuid_t[kDepc + 1]{
                     (static_cast<DataHandleOf<Args>>(deps).guid())...,
-                    NULL_GUID};
+                    kSpilled ? UNINITIALIZED_GUID : NULL_GUID};
             auto j = var_args.begin();
-            for (u32 i = kDepc; i < depc; i++, j++) {
+            for (u32 i = kDepc + kSpillDepc; i < depc; i++, j++) {
                 depv[i] = j->handle().guid();
             }
-        } else {
-            depv = nullptr;
         }
         // Create the task
-        auto task = Task<F>(out_event, template_guid_, param_ptr[0], depc, depv,
-                            hint_, flags_);
-        OCXXR_TEMP_ARRAY_DELETE(depv);  // must be null-safe
+        auto task = Task<F>(out_event, template_guid_, ParamPtr(paramv),
+                            depc, depv, hint_, flags_);
+        if (depv != stack_depv) {
+            OCXXR_TEMP_ARRAY_DELETE(depv);  // must be null-safe
+        }
+        SpillParam(task, params...);
         return task;
     }
 
@@ -987,14 +1252,44 @@ class TaskBuilder<F, void(Params...), void(Args...), void(VarArgs...)> {
         ASSERT((!out_event || flags_ != EDT_PROP_FINISH) &&
                "Created Finish-type EDT, but not using the output event.");
         // Set params (if any)
-        u64 *param_ptr[1 + Task<F>::kParamc] = {
-                reinterpret_cast<u64 *>(&params)..., nullptr};
+        u64 paramv[1 + kParamWords] = {};
+        PackParams(paramv, params...);
         // Create the task
         ASSERT((var_args_count == 0 || kHasVarArgs) &&
                "Only provide var_args_count for tasks with VarArgs")
-        const u32 depc = kDepc + var_args_count;
-        return Task<F>(out_event, template_guid_, param_ptr[0], depc, nullptr,
-                       hint_, flags_);
+        const u32 depc = kDepc + kSpillDepc + var_args_count;
+        auto task = Task<F>(out_event, template_guid_, ParamPtr(paramv),
+                            depc, nullptr, hint_, flags_);
+        SpillParam(task, params...);
+        return task;
+    }
+
+    static u64 *ParamPtr(u64 *paramv) {
+        return kParamWords > 0 ? paramv : nullptr;
+    }
+
+    static void PackParams(u64 *) {}
+
+    // Copy an inline parameter into the words passed as the task's paramv
+    // (a spilled parameter isn't passed there, so nothing is copied)
+    template <typename P>
+    static void PackParams(u64 *paramv, const P &param) {
+        const size_t bytes = std::min(sizeof(P), sizeof(u64) * kParamWords);
+        std::memcpy(paramv, static_cast<const void *>(&param), bytes);
+    }
+
+    static void SpillParam(const Task<F> &) {}
+
+    // Copy a spilled parameter into a new datablock, and add it as the
+    // task's hidden read-only dependence (see SpillTaskParam)
+    template <typename P>
+    static void SpillParam(const Task<F> &task, const P &param) {
+        if (!kSpilled) return;
+        auto db = Datablock<P>::Create();
+        std::memcpy(static_cast<void *>(db.data_ptr()), &param, sizeof(P));
+        db.Release();
+        internal::OK(ocrAddDependence(db.handle().guid(), task.guid(), kDepc,
+                                      AccessMode::kReadOnly));
     }
 
     template <size_t... I, typename... Deps>
@@ -1023,6 +1318,9 @@ class TaskBuilder<F, void(Params...), void(Args...), void(VarArgs...)> {
         return DelayedFuture<F>(task, out_event);
     }
 
+    // dependence count above which CreateFullTask uses the heap
+    static constexpr u32 kStackDepc = 64;
+
     const ocrGuid_t template_guid_;
     const TaskHint *const hint_;
     const u16 flags_;
@@ -1042,13 +1340,21 @@ class TaskTemplate : public ObjectHandle {
     /// The macro #OCXXR_TEMPLATE_FOR(fn_ptr) is provided as a more
     /// convenient way of invoking this function. (Invoking this function
     /// directly is a bit verbose due to the complex template parameters.)
-    template <F *user_fn>
+    ///
+    /// @tparam user_fn The task's function.
+    /// @tparam Policy Optional runtime support for the task's body
+    ///                (e.g., UntrackedTaskPolicy). See also the macro
+    ///                #OCXXR_TEMPLATE_WITH_POLICY(fn_ptr, policy).
+    template <F *user_fn, typename Policy = DefaultTaskPolicy>
     static TaskTemplate<F> Create() {
         ocrGuid_t guid;
-        ocrEdt_t internal_fn = internal::TaskImplementation<F, user_fn, PF, DF,
-                                                            VAF>::InternalFn;
+        ocrEdt_t internal_fn =
+                internal::TaskImplementation<F, user_fn, PF, DF, VAF,
+                                             Policy>::InternalFn;
         constexpr u32 depc =
-                kHasVarArgs ? EDT_PARAM_UNK : internal::FnInfo<F>::kDepCount;
+                kHasVarArgs ? EDT_PARAM_UNK
+                            : internal::FnInfo<F>::kDepCount +
+                                      internal::TaskParamInfo<F>::kSpillDepc;
         constexpr u32 paramc = internal::TaskParamInfo<F>::kParamWordCount;
         ocrEdtTemplateCreate(&guid, internal_fn, paramc, depc);
         return TaskTemplate<F>(guid);
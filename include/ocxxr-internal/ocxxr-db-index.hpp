@@ -0,0 +1,559 @@
+#ifndef OCXXR_DB_INDEX_HPP_
+#define OCXXR_DB_INDEX_HPP_
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace ocxxr {
+namespace internal {
+
+// Finalizer from the SplitMix64 generator (good avalanche, very cheap)
+inline u64 MixBits(u64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline u64 HashGuid(ocrGuid_t guid) {
+    // ocrGuid_t is opaque, and can be 64 or 128 bits depending on the config
+    constexpr size_t kWords =
+            (sizeof(ocrGuid_t) + sizeof(u64) - 1) / sizeof(u64);
+    u64 words[kWords] = {};
+    std::memcpy(words, &guid, sizeof(guid));
+    u64 hash = 0;
+    for (size_t i = 0; i < kWords; i++) {
+        hash = MixBits(hash ^ words[i]);
+    }
+    return hash;
+}
+
+namespace bookkeeping {
+
+// Bookkeeping tables larger than this (in datablocks) are freed when a task
+// finishes rather than being kept around for the next task.
+#ifndef OCXXR_DB_INDEX_RETAIN_CAPACITY
+#define OCXXR_DB_INDEX_RETAIN_CAPACITY 1024
+#endif
+
+// Number of entries in the direct-mapped GUID-to-address lookup cache
+// (must be a power of two)
+#ifndef OCXXR_DB_LOOKUP_CACHE_SIZE
+#define OCXXR_DB_LOOKUP_CACHE_SIZE 16
+#endif
+
+class DbPair {
+ public:
+    DbPair() = default;
+
+    DbPair(ocrGuid_t guid, ptrdiff_t base_addr)
+            : guid_(guid), base_addr_(base_addr) {}
+
+    DbPair(ocrGuid_t guid, void *base_addr)
+            : DbPair(guid, reinterpret_cast<ptrdiff_t>(base_addr)) {}
+
+    explicit DbPair(ocrGuid_t guid) : DbPair(guid, nullptr) {}
+    explicit DbPair(ptrdiff_t base_addr) : DbPair(ERROR_GUID, base_addr) {}
+
+    static bool CompareGuids(const DbPair &a, const DbPair &b) {
+        return ocrGuidIsLt(a.guid_, b.guid_);
+    }
+
+    static bool CompareBases(const DbPair &a, const DbPair &b) {
+        return a.base_addr_ < b.base_addr_;
+    }
+
+    ocrGuid_t guid() const { return guid_; }
+
+    ptrdiff_t base_addr() const { return base_addr_; }
+
+ private:
+    ocrGuid_t guid_;
+    ptrdiff_t base_addr_;
+};
+
+/**
+ * Index of the datablocks currently acquired by a task.
+ *
+ * Each tracked datablock is stored once in a node array. GUID lookups go
+ * through an open-addressing hash table (linear probing, backward-shift
+ * deletion) that maps GUIDs to nodes, and address lookups go through a
+ * top-down splay tree of the same nodes ordered by base address.
+ * Inserts, removals and lookups by GUID are expected O(1), and lookups
+ * by address are amortized O(log N). Everything grows on demand, so there
+ * is no fixed limit on the number of datablocks a task can acquire.
+ *
+ * Pointer-chasing code tends to resolve the same few datablocks over and
+ * over, so lookups can also go through two small caches: a direct-mapped
+ * cache of recent GUID lookups (entries are dropped when their datablock
+ * is untracked), and the address range of the last address lookup (which
+ * is dropped whenever the set of tracked datablocks changes).
+ */
+class AcquiredDbInfo {
+ public:
+    AcquiredDbInfo()
+            : nodes_(nullptr),
+              slots_(nullptr),
+              capacity_(0),
+              used_(0),
+              count_(0),
+              free_(kNil),
+              root_(kNil),
+              caching_(true),
+              cache_used_(false) {
+        std::memset(cache_, 0, sizeof(cache_));
+        ForgetLastAddress();
+    }
+
+    AcquiredDbInfo(const AcquiredDbInfo &) = delete;
+
+    AcquiredDbInfo &operator=(const AcquiredDbInfo &) = delete;
+
+    ~AcquiredDbInfo() {
+        OCXXR_TEMP_ARRAY_DELETE(nodes_);
+        OCXXR_TEMP_ARRAY_DELETE(slots_);
+    }
+
+    /// Number of datablocks currently tracked.
+    u32 count() const { return count_; }
+
+    /// Enable or disable the lookup caches (enabled by default).
+    void set_caching(bool enabled) {
+        ClearCaches();
+        caching_ = enabled;
+    }
+
+    /// @brief Stop tracking all datablocks.
+    ///
+    /// The storage is kept for reuse (unless it has grown past
+    /// OCXXR_DB_INDEX_RETAIN_CAPACITY), and only the hash table slots that
+    /// are actually in use get cleared.
+    void Clear() {
+        if (capacity_ > OCXXR_DB_INDEX_RETAIN_CAPACITY) {
+            OCXXR_TEMP_ARRAY_DELETE(nodes_);
+            OCXXR_TEMP_ARRAY_DELETE(slots_);
+            nodes_ = nullptr;
+            slots_ = nullptr;
+            capacity_ = 0;
+        } else if (count_ == 0) {
+            // nothing to clear in the hash table
+        } else if (4 * count_ >= capacity_) {
+            std::memset(slots_, 0xFF, 2 * capacity_ * sizeof(u32));
+        } else {
+            // Every entry sits in the run of occupied slots starting at its
+            // home slot, so clearing the runs starting at every live entry's
+            // home slot clears the whole table.
+            const u32 mask = slot_mask();
+            for (u32 i = 0; i < used_; i++) {
+                if (nodes_[i].pair.base_addr() == 0) continue;  // free node
+                u32 j = HomeSlot(nodes_[i].pair.guid());
+                while (slots_[j] != kNil) {
+                    slots_[j] = kNil;
+                    j = (j + 1) & mask;
+                }
+            }
+        }
+        used_ = 0;
+        count_ = 0;
+        free_ = kNil;
+        root_ = kNil;
+        ClearCaches();
+    }
+
+    /// @brief Start tracking a datablock.
+    /// @return false if this GUID was already being tracked.
+    bool Insert(ocrGuid_t guid, ptrdiff_t base_addr) {
+        ASSERT(base_addr != 0 && "Should not track null datablocks");
+        if (capacity_ != 0 && slots_[FindSlot(guid)] != kNil) return false;
+        if (free_ == kNil && used_ == capacity_) Grow(capacity_ + 1);
+        u32 index;
+        if (free_ != kNil) {
+            index = free_;
+            free_ = nodes_[index].left;
+        } else {
+            index = used_++;
+        }
+        Node &node = nodes_[index];
+        node.pair = DbPair(guid, base_addr);
+        slots_[FindSlot(guid)] = index;
+        TreeInsert(index);
+        ++count_;
+        ForgetLastAddress();
+        return true;
+    }
+
+    /// @brief Start tracking a batch of datablocks (e.g., a task's depv).
+    ///
+    /// Null dependences are skipped, and duplicates are only tracked once.
+    /// When the index is empty (as it is when a task starts), the batch is
+    /// sorted once and the tree is built directly in O(N log N) total,
+    /// rather than doing N separate insertions.
+    void InsertAll(u32 depc, const ocrEdtDep_t depv[]) {
+        if (used_ != 0) {
+            // already in use, so just add them incrementally
+            for (u32 i = 0; i < depc; i++) {
+                if (!depv[i].ptr) continue;
+                Insert(depv[i].guid, reinterpret_cast<ptrdiff_t>(depv[i].ptr));
+            }
+            return;
+        }
+        u32 n = 0;
+        for (u32 i = 0; i < depc; i++) {
+            if (depv[i].ptr) ++n;
+        }
+        if (n == 0) return;
+        if (n > capacity_) Grow(n);
+        n = 0;
+        for (u32 i = 0; i < depc; i++) {
+            if (depv[i].ptr) {
+                nodes_[n++].pair = DbPair(depv[i].guid, depv[i].ptr);
+            }
+        }
+        std::sort(nodes_, nodes_ + n, [](const Node &a, const Node &b) {
+            return DbPair::CompareBases(a.pair, b.pair);
+        });
+        // Duplicates (the same datablock in several slots) are now adjacent
+        u32 unique = 1;
+        for (u32 i = 1; i < n; i++) {
+            const DbPair &prev = nodes_[unique - 1].pair;
+            if (nodes_[i].pair.base_addr() != prev.base_addr()) {
+                nodes_[unique++] = nodes_[i];
+            } else {
+                ASSERT(ocrGuidIsEq(nodes_[i].pair.guid(), prev.guid()) &&
+                       "Tracked two datablocks with the same base address");
+            }
+        }
+        for (u32 i = 0; i < unique; i++) {
+            slots_[FindSlot(nodes_[i].pair.guid())] = i;
+        }
+        used_ = count_ = unique;
+        root_ = BuildTree(0, unique);
+        ForgetLastAddress();
+    }
+
+    /// @brief Stop tracking a datablock.
+    /// @return the datablock's base address, or 0 if it was not tracked.
+    ptrdiff_t Remove(ocrGuid_t guid) {
+        if (count_ == 0) return 0;
+        const u32 slot = FindSlot(guid);
+        const u32 index = slots_[slot];
+        if (index == kNil) return 0;
+        EraseSlot(slot);
+        Node &node = nodes_[index];
+        const ptrdiff_t base_addr = node.pair.base_addr();
+        TreeRemove(base_addr);
+        ForgetGuid(guid);
+        ForgetLastAddress();
+        // mark as free (base address zero is never tracked)
+        node.pair = DbPair();
+        node.left = free_;
+        free_ = index;
+        --count_;
+        return base_addr;
+    }
+
+    /// @brief Look up a tracked datablock by GUID.
+    /// @return the datablock's base address, or 0 if it was not tracked.
+    ptrdiff_t Find(ocrGuid_t guid) {
+        if (count_ == 0) return 0;
+        DbPair *cached = nullptr;
+        if (caching_) {
+            cached = &cache_[CacheSlot(guid)];
+            if (cached->base_addr() != 0 &&
+                ocrGuidIsEq(cached->guid(), guid)) {
+                return cached->base_addr();
+            }
+        }
+        const u32 index = slots_[FindSlot(guid)];
+        if (index == kNil) return 0;
+        const DbPair &pair = nodes_[index].pair;
+        if (cached) {
+            *cached = pair;
+            cache_used_ = true;
+        }
+        return pair.base_addr();
+    }
+
+    /// @brief Find the tracked datablock with the greatest base address
+    ///        less than or equal to @p addr.
+    /// @param[out] floor The matching datablock.
+    /// @param[out] next_base Base address of the following datablock
+    ///                       (or the maximum address if there is none).
+    /// @return false if @p addr is below every tracked datablock.
+    bool FindByAddress(ptrdiff_t addr, DbPair *floor, ptrdiff_t *next_base) {
+        if (last_floor_.base_addr() <= addr && addr < last_next_base_) {
+            *floor = last_floor_;
+            *next_base = last_next_base_;
+            return true;
+        }
+        if (root_ == kNil) return false;
+        root_ = Splay(root_, addr);
+        Node &root = nodes_[root_];
+        u32 lo, hi;
+        if (root.pair.base_addr() <= addr) {
+            // root is the floor, successor is the min of the right subtree
+            root.right = Splay(root.right, addr);
+            lo = root_;
+            hi = root.right;
+        } else {
+            // root is the ceiling, floor is the max of the left subtree
+            root.left = Splay(root.left, addr);
+            lo = root.left;
+            hi = root_;
+        }
+        if (lo == kNil) return false;
+        *floor = nodes_[lo].pair;
+        *next_base = (hi == kNil) ? std::numeric_limits<ptrdiff_t>::max()
+                                  : nodes_[hi].pair.base_addr();
+        if (caching_) {
+            last_floor_ = *floor;
+            last_next_base_ = *next_base;
+        }
+        return true;
+    }
+
+ private:
+    static constexpr u32 kNil = ~static_cast<u32>(0);
+    static constexpr u32 kInitialCapacity = 16;
+    static constexpr u32 kCacheSize = OCXXR_DB_LOOKUP_CACHE_SIZE;
+
+    static_assert(kCacheSize > 0 && (kCacheSize & (kCacheSize - 1)) == 0,
+                  "Lookup cache size must be a power of two");
+
+    struct Node {
+        DbPair pair;
+        u32 left;
+        u32 right;
+    };
+
+    // The hash table always has twice as many slots as there are nodes,
+    // keeping the load factor at or below 1/2.
+    u32 slot_mask() const { return 2 * capacity_ - 1; }
+
+    u32 HomeSlot(ocrGuid_t guid) const {
+        return static_cast<u32>(HashGuid(guid)) & slot_mask();
+    }
+
+    u32 FindSlot(ocrGuid_t guid) const {
+        const u32 mask = slot_mask();
+        u32 i = HomeSlot(guid);
+        while (slots_[i] != kNil &&
+               !ocrGuidIsEq(nodes_[slots_[i]].pair.guid(), guid)) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void EraseSlot(u32 i) {
+        const u32 mask = slot_mask();
+        u32 j = i;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (slots_[j] == kNil) break;
+            const u32 home = HomeSlot(nodes_[slots_[j]].pair.guid());
+            // Skip entries whose home slot lies cyclically within (i, j]
+            const bool stays = (i <= j) ? (i < home && home <= j)
+                                        : (i < home || home <= j);
+            if (!stays) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i] = kNil;
+    }
+
+    void Grow(u32 min_capacity) {
+        u32 new_capacity = capacity_ ? 2 * capacity_ : kInitialCapacity;
+        while (new_capacity < min_capacity) new_capacity *= 2;
+        Node *new_nodes = OCXXR_TEMP_ARRAY_NEW(Node, new_capacity);
+        if (used_ > 0) {
+            std::memcpy(new_nodes, nodes_, used_ * sizeof(Node));
+        }
+        OCXXR_TEMP_ARRAY_DELETE(nodes_);
+        OCXXR_TEMP_ARRAY_DELETE(slots_);
+        nodes_ = new_nodes;
+        capacity_ = new_capacity;
+        slots_ = OCXXR_TEMP_ARRAY_NEW(u32, 2 * new_capacity);
+        std::memset(slots_, 0xFF, 2 * new_capacity * sizeof(u32));
+        for (u32 i = 0; i < used_; i++) {
+            if (nodes_[i].pair.base_addr() == 0) continue;  // free node
+            slots_[FindSlot(nodes_[i].pair.guid())] = i;
+        }
+    }
+
+    //-----------------------------------------------
+    // Lookup caches
+    //-----------------------------------------------
+
+    // The cache is tiny, so a single multiplicative hash is enough here
+    static u32 CacheSlot(ocrGuid_t guid) {
+        constexpr size_t kWords =
+                (sizeof(ocrGuid_t) + sizeof(u64) - 1) / sizeof(u64);
+        u64 words[kWords] = {};
+        std::memcpy(words, &guid, sizeof(guid));
+        u64 folded = 0;
+        for (size_t i = 0; i < kWords; i++) {
+            folded ^= words[i];
+        }
+        // Fibonacci hashing: the upper bits of the product are well mixed
+        return static_cast<u32>((folded * 0x9e3779b97f4a7c15ULL) >> 32) &
+               (kCacheSize - 1);
+    }
+
+    void ForgetGuid(ocrGuid_t guid) {
+        DbPair &cached = cache_[CacheSlot(guid)];
+        if (ocrGuidIsEq(cached.guid(), guid)) {
+            cached = DbPair(NULL_GUID, static_cast<ptrdiff_t>(0));
+        }
+    }
+
+    // An empty range (no address is both >= max and < 0)
+    void ForgetLastAddress() {
+        last_floor_ = DbPair(std::numeric_limits<ptrdiff_t>::max());
+        last_next_base_ = 0;
+    }
+
+    void ClearCaches() {
+        if (cache_used_) {
+            std::memset(cache_, 0, sizeof(cache_));
+            cache_used_ = false;
+        }
+        ForgetLastAddress();
+    }
+
+    //-----------------------------------------------
+    // Splay tree (ordered by base address)
+    //-----------------------------------------------
+
+    ptrdiff_t key(u32 index) const { return nodes_[index].pair.base_addr(); }
+
+    // Top-down splay (Sleator & Tarjan, 1985). Returns the new subtree root,
+    // which is the node with the given key, or the last node on its search
+    // path (i.e., the key's floor or ceiling within the subtree).
+    u32 Splay(u32 t, ptrdiff_t k) {
+        if (t == kNil) return t;
+        u32 left_tree = kNil;   // nodes less than k
+        u32 right_tree = kNil;  // nodes greater than k
+        u32 *left_hook = &left_tree;
+        u32 *right_hook = &right_tree;
+        for (;;) {
+            if (k < key(t)) {
+                u32 y = nodes_[t].left;
+                if (y == kNil) break;
+                if (k < key(y)) {  // rotate right
+                    nodes_[t].left = nodes_[y].right;
+                    nodes_[y].right = t;
+                    t = y;
+                    if (nodes_[t].left == kNil) break;
+                }
+                *right_hook = t;  // link right
+                right_hook = &nodes_[t].left;
+                t = nodes_[t].left;
+            } else if (k > key(t)) {
+                u32 y = nodes_[t].right;
+                if (y == kNil) break;
+                if (k > key(y)) {  // rotate left
+                    nodes_[t].right = nodes_[y].left;
+                    nodes_[y].left = t;
+                    t = y;
+                    if (nodes_[t].right == kNil) break;
+                }
+                *left_hook = t;  // link left
+                left_hook = &nodes_[t].right;
+                t = nodes_[t].right;
+            } else {
+                break;
+            }
+        }
+        // reassemble
+        *left_hook = nodes_[t].left;
+        *right_hook = nodes_[t].right;
+        nodes_[t].left = left_tree;
+        nodes_[t].right = right_tree;
+        return t;
+    }
+
+    // Build a balanced tree from the (sorted) nodes in [lo, hi)
+    u32 BuildTree(u32 lo, u32 hi) {
+        if (lo >= hi) return kNil;
+        const u32 mid = lo + (hi - lo) / 2;
+        nodes_[mid].left = BuildTree(lo, mid);
+        nodes_[mid].right = BuildTree(mid + 1, hi);
+        return mid;
+    }
+
+    void TreeInsert(u32 index) {
+        Node &node = nodes_[index];
+        const ptrdiff_t k = node.pair.base_addr();
+        if (root_ == kNil) {
+            node.left = node.right = kNil;
+        } else {
+            root_ = Splay(root_, k);
+            Node &root = nodes_[root_];
+            if (k == root.pair.base_addr()) {
+                // Two live datablocks can't share a base address, so the
+                // old entry must be for a datablock that has since been
+                // destroyed (and its memory reused). Replace it.
+                const u32 stale = root_;
+                node.left = root.left;
+                node.right = root.right;
+                root_ = index;
+                EraseSlot(FindSlot(root.pair.guid()));
+                ForgetGuid(root.pair.guid());
+                root.pair = DbPair();
+                root.left = free_;
+                free_ = stale;
+                --count_;
+                return;
+            }
+            if (k < root.pair.base_addr()) {
+                node.left = root.left;
+                node.right = root_;
+                root.left = kNil;
+            } else {
+                node.right = root.right;
+                node.left = root_;
+                root.right = kNil;
+            }
+        }
+        root_ = index;
+    }
+
+    void TreeRemove(ptrdiff_t k) {
+        root_ = Splay(root_, k);
+        Node &root = nodes_[root_];
+        ASSERT(root.pair.base_addr() == k &&
+               "Matching base address for datablock GUID not found");
+        if (root.left == kNil) {
+            root_ = root.right;
+        } else {
+            // every key in the left subtree is smaller than k,
+            // so splaying brings its maximum to the top
+            const u32 right = root.right;
+            root_ = Splay(root.left, k);
+            nodes_[root_].right = right;
+        }
+    }
+
+    Node *nodes_;  // node storage (shared by the hash table and the tree)
+    u32 *slots_;   // hash table slots (node indices)
+    u32 capacity_;  // node capacity (the hash table has 2x as many slots)
+    u32 used_;      // high-water mark of the node array
+    u32 count_;     // number of live nodes
+    u32 free_;      // head of the free-node list (linked through Node::left)
+    u32 root_;      // root of the splay tree
+    bool caching_;     // use the lookup caches?
+    bool cache_used_;  // anything (possibly) in the GUID cache?
+    DbPair cache_[kCacheSize];  // recent GUID lookups (base 0 if empty)
+    DbPair last_floor_;         // result of the last address lookup...
+    ptrdiff_t last_next_base_;  // ...which holds for [floor, next_base)
+};
+
+}  // namespace bookkeeping
+}  // namespace internal
+}  // namespace ocxxr
+
+#endif  // OCXXR_DB_INDEX_HPP_
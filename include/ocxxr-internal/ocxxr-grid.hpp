@@ -0,0 +1,345 @@
+#ifndef OCXXR_GRID_HPP_
+#define OCXXR_GRID_HPP_
+/// @file
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace ocxxr {
+
+/// Marks an extent of a GridView that is only known at run time.
+static constexpr size_t kDynamicExtent = ~static_cast<size_t>(0);
+
+namespace internal {
+
+template <size_t... E>
+struct CountDynamicExtents;
+
+template <>
+struct CountDynamicExtents<> {
+    static constexpr size_t value = 0;
+};
+
+template <size_t First, size_t... Rest>
+struct CountDynamicExtents<First, Rest...> {
+    static constexpr size_t value = (First == kDynamicExtent ? 1 : 0) +
+                                    CountDynamicExtents<Rest...>::value;
+};
+
+}  // namespace internal
+
+/**
+ * The extents (size in each dimension) of a GridView.
+ *
+ * Each extent is either fixed at compile time, or kDynamicExtent, in which
+ * case it is passed to the constructor. Fixed extents let the compiler
+ * fold the index arithmetic into constants:
+ *
+ *     Extents<kDynamicExtent, 64> rows_of_64(rows);
+ */
+template <size_t... E>
+class Extents {
+ public:
+    static constexpr size_t kRank = sizeof...(E);
+    static constexpr size_t kDynamicRank =
+            internal::CountDynamicExtents<E...>::value;
+
+    static_assert(kRank > 0, "Extents must have at least one dimension.");
+
+    /// @param[in] sizes The dynamic extents, in order.
+    template <typename... Sizes>
+    explicit Extents(Sizes... sizes) {
+        static_assert(sizeof...(Sizes) == kDynamicRank,
+                      "Expected one size per dynamic extent.");
+        const size_t dynamic[] = {static_cast<size_t>(sizes)..., 0};
+        size_t d = 0;
+        for (size_t r = 0; r < kRank; r++) {
+            extents_[r] = kStatic[r] == kDynamicExtent ? dynamic[d++]
+                                                       : kStatic[r];
+        }
+    }
+
+    /// The size of dimension `r`.
+    size_t extent(size_t r) const {
+        return kStatic[r] == kDynamicExtent ? extents_[r] : kStatic[r];
+    }
+
+    /// Total number of elements.
+    size_t size() const {
+        size_t total = 1;
+        for (size_t r = 0; r < kRank; r++) {
+            total *= extent(r);
+        }
+        return total;
+    }
+
+ private:
+    static constexpr size_t kStatic[kRank] = {E...};
+
+    size_t extents_[kRank];
+};
+
+template <size_t... E>
+constexpr size_t Extents<E...>::kStatic[];
+
+namespace internal {
+
+template <size_t Rank, size_t... E>
+struct DynamicExtents {
+    typedef typename DynamicExtents<Rank - 1, kDynamicExtent, E...>::Type Type;
+};
+
+template <size_t... E>
+struct DynamicExtents<0, E...> {
+    typedef Extents<E...> Type;
+};
+
+// Spread the low 32 bits of x out to the even bit positions.
+inline u64 SpreadBits(u64 x) {
+#ifdef __BMI2__
+    return _pdep_u64(x, 0x5555555555555555ull);
+#else
+    x &= 0xFFFFFFFFull;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+#endif
+}
+
+}  // namespace internal
+
+/// Extents of the given rank, all dynamic.
+template <size_t Rank>
+using Dims = typename internal::DynamicExtents<Rank>::Type;
+
+// A layout maps a GridView's indices to an offset in its storage. Each
+// layout has a nested Mapping<Extents> class providing operator()(indices)
+// and required_size(), the number of elements of storage it needs.
+
+/// Layout with the last index varying fastest (as in C arrays).
+struct RowMajor {
+    template <typename E>
+    class Mapping {
+     public:
+        explicit Mapping(const E &extents) : extents_(extents) {}
+
+        const E &extents() const { return extents_; }
+
+        size_t required_size() const { return extents_.size(); }
+
+        template <typename... I>
+        size_t operator()(I... indices) const {
+            const size_t index[] = {static_cast<size_t>(indices)...};
+            size_t offset = 0;
+            for (size_t r = 0; r < E::kRank; r++) {
+                offset = offset * extents_.extent(r) + index[r];
+            }
+            return offset;
+        }
+
+     private:
+        E extents_;
+    };
+};
+
+/// Layout with the first index varying fastest (as in Fortran arrays).
+struct ColumnMajor {
+    template <typename E>
+    class Mapping {
+     public:
+        explicit Mapping(const E &extents) : extents_(extents) {}
+
+        const E &extents() const { return extents_; }
+
+        size_t required_size() const { return extents_.size(); }
+
+        template <typename... I>
+        size_t operator()(I... indices) const {
+            const size_t index[] = {static_cast<size_t>(indices)...};
+            size_t offset = 0;
+            for (size_t r = E::kRank; r-- > 0;) {
+                offset = offset * extents_.extent(r) + index[r];
+            }
+            return offset;
+        }
+
+     private:
+        E extents_;
+    };
+};
+
+/// @brief 2D layout made of row-major tiles, stored in row-major order.
+///
+/// Neighbouring elements in both dimensions are usually in the same tile,
+/// which improves locality for stencils. The extents are rounded up to a
+/// whole number of tiles, so the storage may be a bit bigger than the grid.
+/// Tile sizes that are powers of two make the index arithmetic cheapest.
+template <size_t TileRows, size_t TileCols>
+struct Tiled {
+    static_assert(TileRows > 0 && TileCols > 0, "Tiles can't be empty.");
+
+    template <typename E>
+    class Mapping {
+     public:
+        static_assert(E::kRank == 2, "Tiled layout is only for 2D grids.");
+
+        explicit Mapping(const E &extents)
+                : extents_(extents),
+                  tiles_per_row_((extents.extent(1) + TileCols - 1) /
+                                 TileCols) {}
+
+        const E &extents() const { return extents_; }
+
+        size_t required_size() const {
+            const size_t tile_rows = (extents_.extent(0) + TileRows - 1) /
+                                     TileRows;
+            return tile_rows * tiles_per_row_ * TileRows * TileCols;
+        }
+
+        size_t operator()(size_t row, size_t col) const {
+            const size_t tile = (row / TileRows) * tiles_per_row_ +
+                                col / TileCols;
+            return tile * (TileRows * TileCols) +
+                   (row % TileRows) * TileCols + col % TileCols;
+        }
+
+     private:
+        E extents_;
+        size_t tiles_per_row_;
+    };
+};
+
+/// @brief 2D layout in Morton (Z-order), interleaving the index bits.
+///
+/// Each aligned square of 2^k by 2^k elements is contiguous, which gives
+/// good locality in both dimensions at every scale. Grids that aren't
+/// square powers of two leave some of the storage unused. Indices must
+/// fit in 32 bits.
+struct Morton {
+    template <typename E>
+    class Mapping {
+     public:
+        static_assert(E::kRank == 2, "Morton layout is only for 2D grids.");
+
+        explicit Mapping(const E &extents) : extents_(extents) {
+            ASSERT(extents.extent(0) <= (u64{1} << 32) &&
+                   extents.extent(1) <= (u64{1} << 32));
+        }
+
+        const E &extents() const { return extents_; }
+
+        size_t required_size() const {
+            // the offset increases with each index, so the last element
+            // has the highest offset
+            if (extents_.size() == 0) return 0;
+            return (*this)(extents_.extent(0) - 1, extents_.extent(1) - 1) + 1;
+        }
+
+        size_t operator()(size_t row, size_t col) const {
+            return (internal::SpreadBits(row) << 1) |
+                   internal::SpreadBits(col);
+        }
+
+     private:
+        E extents_;
+    };
+};
+
+/**
+ * A multidimensional view of contiguous storage (like std::mdspan).
+ *
+ * Unlike an array of row pointers, the whole grid is one block of memory
+ * (e.g., a datablock or a single arena allocation), and finding an element
+ * is just index arithmetic, with no extra loads. The Layout decides the
+ * order of the elements in memory: RowMajor, ColumnMajor, Tiled or Morton.
+ *
+ *     typedef GridView<double, Dims<2>, Tiled<8, 8>> Grid;
+ *     Dims<2> extents(rows, cols);
+ *     auto db = ArrayDatablock<double>::Create(Grid::RequiredSize(extents));
+ *     Grid grid(db.data(), extents);
+ *     grid(i, j) = 0.0;
+ *
+ * A view holds a raw pointer, so (like ArraySlice) it is only valid while
+ * the storage is acquired; store the storage, not the view, in a datablock.
+ */
+template <typename T, typename E, typename Layout = RowMajor>
+class GridView {
+ public:
+    typedef T value_type;
+    typedef E extents_type;
+    typedef typename Layout::template Mapping<E> mapping_type;
+
+    static constexpr size_t kRank = E::kRank;
+
+    /// @brief Number of elements of storage needed for a grid.
+    ///
+    /// This can be more than the number of elements in the grid (e.g., for
+    /// the Tiled and Morton layouts).
+    static size_t RequiredSize(const E &extents) {
+        return mapping_type(extents).required_size();
+    }
+
+    /// @brief Allocate a grid in the current arena (see ocxxr::NewArray).
+    static GridView New(const E &extents) {
+        return GridView(NewArray<T>(RequiredSize(extents)), extents);
+    }
+
+    GridView(T *data, const E &extents) : data_(data), mapping_(extents) {}
+
+    T &operator()(size_t i) const {
+        static_assert(kRank == 1, "Expected one index per dimension.");
+        ASSERT(i < extent(0));
+        return data_[mapping_(i)];
+    }
+
+    T &operator()(size_t i, size_t j) const {
+        static_assert(kRank == 2, "Expected one index per dimension.");
+        ASSERT(i < extent(0) && j < extent(1));
+        return data_[mapping_(i, j)];
+    }
+
+    template <typename... I>
+    T &operator()(size_t i, size_t j, size_t k, I... rest) const {
+        static_assert(sizeof...(I) + 3 == kRank,
+                      "Expected one index per dimension.");
+        ASSERT(InBounds(i, j, k, rest...));
+        return data_[mapping_(i, j, k, rest...)];
+    }
+
+    /// The size of dimension `r`.
+    size_t extent(size_t r) const { return mapping_.extents().extent(r); }
+
+    const E &extents() const { return mapping_.extents(); }
+
+    /// Number of elements in the grid.
+    size_t size() const { return extents().size(); }
+
+    /// Number of elements of storage used by the grid.
+    size_t required_size() const { return mapping_.required_size(); }
+
+    /// The underlying storage.
+    T *data() const { return data_; }
+
+    const mapping_type &mapping() const { return mapping_; }
+
+ private:
+    template <typename... I>
+    bool InBounds(I... indices) const {
+        const size_t index[] = {static_cast<size_t>(indices)...};
+        for (size_t r = 0; r < kRank; r++) {
+            if (index[r] >= extent(r)) return false;
+        }
+        return true;
+    }
+
+    T *data_;
+    mapping_type mapping_;
+};
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_GRID_HPP_
@@ -0,0 +1,338 @@
+#ifndef OCXXR_REL_CONTAINERS_HPP_
+#define OCXXR_REL_CONTAINERS_HPP_
+
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+namespace ocxxr {
+
+/**
+ * A non-owning view of a contiguous array, stored as a relative pointer and
+ * a size. It can be stored in an arena along with the array it views.
+ *
+ * Note: Arena#Compact treats the viewed elements as a separate array, so a
+ * span should only be compacted if it views a whole array that nothing
+ * else in the arena points into.
+ */
+template <typename T>
+class RelSpan {
+ public:
+    typedef T value_type;
+    typedef T *iterator;
+
+    RelSpan() : data_(nullptr), size_(0) {}
+
+    RelSpan(T *data, size_t size) : data_(data), size_(size) {}
+
+    RelSpan(const RelSpan &other) = default;
+
+    RelSpan &operator=(const RelSpan &other) = default;
+
+    T *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    T &operator[](size_t index) const {
+        ASSERT(index < size_ && "RelSpan index out of bounds");
+        return data_[index];
+    }
+
+    T *begin() const { return data_; }
+
+    T *end() const { return data() + size_; }
+
+    /// View of `count` elements starting at `offset`.
+    RelSpan subspan(size_t offset, size_t count) const {
+        ASSERT(offset + count <= size_ && "RelSpan subspan out of bounds");
+        return RelSpan(data() + offset, count);
+    }
+
+ private:
+    RelPtr<T> data_;
+    size_t size_;
+
+    friend struct PointerFields<RelSpan>;
+};
+
+/**
+ * A growable array stored in an arena, as a relative pointer, size and
+ * capacity. The elements are contiguous, and the vector (and its
+ * elements) stay valid when the datablock holding them is copied or moved.
+ *
+ * Storage is allocated from the current implicit arena (see
+ * SetImplicitArena), which must be the arena holding the vector for it to
+ * stay relocatable. The capacity doubles as the vector grows. The old
+ * storage is only reused if the arena uses ArenaMode::kFreeList, so it's
+ * better to reserve the capacity up front when the final size is known.
+ * Storage is freed through the implicit arena too, so it's only reused if
+ * that is still the vector's arena when the vector grows or is destroyed
+ * (otherwise, it's left in place).
+ *
+ * The vector can be moved but not copied, since a copy would have to
+ * allocate new storage in whatever the implicit arena happens to be.
+ */
+template <typename T>
+class RelVector {
+ public:
+    typedef T value_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+
+    RelVector() : data_(nullptr), size_(0), capacity_(0) {}
+
+    /// Create a vector with `count` value-initialized elements.
+    explicit RelVector(size_t count) : RelVector() { resize(count); }
+
+    RelVector(std::initializer_list<T> values) : RelVector() {
+        reserve(values.size());
+        for (const T &value : values) {
+            push_back(value);
+        }
+    }
+
+    RelVector(RelVector &&other) : RelVector() { swap(other); }
+
+    RelVector &operator=(RelVector &&other) {
+        swap(other);
+        return *this;
+    }
+
+    RelVector(const RelVector &) = delete;
+
+    RelVector &operator=(const RelVector &) = delete;
+
+    ~RelVector() {
+        clear();
+        Deallocate(data(), capacity_);
+    }
+
+    T *data() { return data_; }
+
+    const T *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    size_t capacity() const { return capacity_; }
+
+    bool empty() const { return size_ == 0; }
+
+    T &operator[](size_t index) {
+        ASSERT(index < size_ && "RelVector index out of bounds");
+        return data()[index];
+    }
+
+    const T &operator[](size_t index) const {
+        ASSERT(index < size_ && "RelVector index out of bounds");
+        return data()[index];
+    }
+
+    T &front() { return (*this)[0]; }
+
+    T &back() { return (*this)[size_ - 1]; }
+
+    T *begin() { return data(); }
+
+    T *end() { return data() + size_; }
+
+    const T *begin() const { return data(); }
+
+    const T *end() const { return data() + size_; }
+
+    RelSpan<T> span() { return RelSpan<T>(data(), size_); }
+
+    RelSpan<const T> span() const { return RelSpan<const T>(data(), size_); }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            Reallocate(capacity);
+        }
+    }
+
+    void resize(size_t size) {
+        reserve(size);
+        while (size_ < size) {
+            ::new (data() + size_) T();
+            size_++;
+        }
+        while (size_ > size) {
+            pop_back();
+        }
+    }
+
+    template <typename... Args>
+    T &emplace_back(Args &&... args) {
+        if (size_ == capacity_) {
+            Reallocate(capacity_ ? 2 * capacity_ : kMinCapacity);
+        }
+        T *element = ::new (data() + size_) T(std::forward<Args>(args)...);
+        size_++;
+        return *element;
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        ASSERT(size_ > 0 && "pop_back on an empty RelVector");
+        size_--;
+        data()[size_].~T();
+    }
+
+    void clear() {
+        while (size_ > 0) {
+            pop_back();
+        }
+    }
+
+    void swap(RelVector &other) {
+        T *other_data = other.data_;
+        other.data_ = data_;
+        data_ = other_data;
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+ private:
+    static constexpr size_t kMinCapacity = 4;
+
+    static T *Allocate(size_t count) {
+        auto arena = internal::dballoc::AllocatorGet();
+        return static_cast<T *>(arena.allocate(sizeof(T), count, alignof(T)));
+    }
+
+    static void Deallocate(T *data, size_t count) {
+        if (data) {
+            internal::dballoc::DeallocateInImplicitArena(data, sizeof(T),
+                                                        count);
+        }
+    }
+
+    void Reallocate(size_t capacity) {
+        T *old_data = data();
+        T *new_data = Allocate(capacity);
+        // move the elements (which might contain relative pointers,
+        // so they can't just be copied byte-for-byte)
+        for (size_t i = 0; i < size_; i++) {
+            ::new (new_data + i) T(std::move(old_data[i]));
+            old_data[i].~T();
+        }
+        Deallocate(old_data, capacity_);
+        data_ = new_data;
+        capacity_ = capacity;
+    }
+
+    RelPtr<T> data_;
+    size_t size_;
+    size_t capacity_;
+
+    friend struct PointerFields<RelVector>;
+};
+
+/**
+ * A null-terminated string stored in an arena (see RelVector).
+ */
+class RelString {
+ public:
+    RelString() {}
+
+    RelString(const char *str) { assign(str); }
+
+    RelString(const char *str, size_t length) { assign(str, length); }
+
+    RelString &operator=(const char *str) {
+        assign(str);
+        return *this;
+    }
+
+    void assign(const char *str) { assign(str, std::strlen(str)); }
+
+    void assign(const char *str, size_t length) {
+        chars_.clear();
+        append(str, length);
+    }
+
+    void append(const char *str) { append(str, std::strlen(str)); }
+
+    void append(const char *str, size_t length) {
+        if (!chars_.empty()) {
+            chars_.pop_back();  // terminator
+        }
+        chars_.reserve(chars_.size() + length + 1);
+        for (size_t i = 0; i < length; i++) {
+            chars_.push_back(str[i]);
+        }
+        chars_.push_back('\0');
+    }
+
+    RelString &operator+=(const char *str) {
+        append(str);
+        return *this;
+    }
+
+    const char *c_str() const { return empty() ? "" : chars_.data(); }
+
+    const char *data() const { return c_str(); }
+
+    size_t size() const { return empty() ? 0 : chars_.size() - 1; }
+
+    size_t length() const { return size(); }
+
+    bool empty() const { return chars_.size() <= 1; }
+
+    char operator[](size_t index) const {
+        ASSERT(index < size() && "RelString index out of bounds");
+        return chars_[index];
+    }
+
+    bool operator==(const char *str) const {
+        return std::strcmp(c_str(), str) == 0;
+    }
+
+    bool operator!=(const char *str) const { return !(*this == str); }
+
+    bool operator==(const RelString &other) const {
+        return size() == other.size() && *this == other.c_str();
+    }
+
+    bool operator!=(const RelString &other) const { return !(*this == other); }
+
+ private:
+    RelVector<char> chars_;
+
+    friend struct PointerFields<RelString>;
+};
+
+/// Arena#Compact support for RelSpan (see the RelSpan notes).
+template <typename T>
+struct PointerFields<RelSpan<T>> {
+    template <typename V>
+    static void Visit(RelSpan<T> &span, V &visitor) {
+        visitor(span.data_, span.size_);
+    }
+};
+
+/// Arena#Compact support for RelVector (keeps the whole capacity).
+template <typename T>
+struct PointerFields<RelVector<T>> {
+    template <typename V>
+    static void Visit(RelVector<T> &vector, V &visitor) {
+        visitor(vector.data_, vector.capacity_, vector.size_);
+    }
+};
+
+/// Arena#Compact support for RelString.
+template <>
+struct PointerFields<RelString> {
+    template <typename V>
+    static void Visit(RelString &string, V &visitor) {
+        PointerFields<RelVector<char>>::Visit(string.chars_, visitor);
+    }
+};
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_REL_CONTAINERS_HPP_
@@ -0,0 +1,496 @@
+#ifndef OCXXR_REL_HASH_MAP_HPP_
+#define OCXXR_REL_HASH_MAP_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace ocxxr {
+namespace internal {
+namespace hashing {
+
+// Control bytes: a full slot holds the low 7 bits of its key's hash, and
+// the special values are negative, so a byte's sign bit marks it as free.
+constexpr int8_t kEmpty = -128;
+constexpr int8_t kDeleted = -2;
+
+// Slots are probed in groups of this many control bytes. This is part of
+// the data layout (the control array is padded by a group's worth of
+// bytes), so it's fixed rather than depending on the available SIMD width.
+constexpr size_t kGroupWidth = 16;
+
+// Bit counts for (non-zero) group masks
+inline int TrailingZeros(u32 mask) { return __builtin_ctz(mask); }
+
+inline int LeadingZeros(u32 mask) {
+    return __builtin_clz(mask) - (32 - static_cast<int>(kGroupWidth));
+}
+
+// Compares a group of control bytes against a value, all at once
+class ProbeGroup {
+ public:
+#ifdef __SSE2__
+    explicit ProbeGroup(const int8_t *ctrl)
+            : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {
+    }
+
+    // bit i is set if control byte i equals h2
+    u32 Match(int8_t h2) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+    }
+
+    u32 MatchEmpty() const { return Match(kEmpty); }
+
+    u32 MatchFree() const { return _mm_movemask_epi8(ctrl_); }
+
+ private:
+    __m128i ctrl_;
+#else
+    explicit ProbeGroup(const int8_t *ctrl) : ctrl_(ctrl) {}
+
+    u32 Match(int8_t h2) const {
+        u32 mask = 0;
+        for (size_t i = 0; i < kGroupWidth; i++) {
+            mask |= static_cast<u32>(ctrl_[i] == h2) << i;
+        }
+        return mask;
+    }
+
+    u32 MatchEmpty() const { return Match(kEmpty); }
+
+    u32 MatchFree() const {
+        u32 mask = 0;
+        for (size_t i = 0; i < kGroupWidth; i++) {
+            mask |= static_cast<u32>(ctrl_[i] < 0) << i;
+        }
+        return mask;
+    }
+
+ private:
+    const int8_t *ctrl_;
+#endif
+};
+
+}  // namespace hashing
+}  // namespace internal
+
+/**
+ * An open-addressing hash map stored in an arena.
+ *
+ * The map uses a "Swiss table" layout: an array of one-byte control codes
+ * (holding 7 bits of each key's hash) alongside the array of entries.
+ * Lookups compare a whole group of 16 control bytes at once (using SSE2
+ * where available), and only compare keys for the matching slots.
+ *
+ * Both arrays are allocated from the current implicit arena (see
+ * SetImplicitArena) and referenced by relative pointers. If the map is
+ * stored in that arena too, the whole index can be handed to other tasks
+ * as part of the arena, without being rebuilt. (Arena#Compact copies the
+ * map, but doesn't follow any pointers in its keys or values.) As with
+ * RelVector, old arrays are only freed if that arena is still the
+ * implicit arena when the map grows or is destroyed.
+ *
+ * Keys and values are stored as `std::pair<const K, V>` entries, which
+ * move when the table grows, so references to entries are only valid
+ * until the next insertion.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class RelHashMap {
+ public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<const K, V> value_type;
+
+    template <typename E>
+    class Iterator {
+     public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef E value_type;
+        typedef ptrdiff_t difference_type;
+        typedef E *pointer;
+        typedef E &reference;
+
+        E &operator*() const { return map_->slots()[index_]; }
+
+        E *operator->() const { return &**this; }
+
+        Iterator &operator++() {
+            index_++;
+            SkipFree();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return index_ != other.index_;
+        }
+
+     private:
+        Iterator(const RelHashMap *map, size_t index)
+                : map_(map), index_(index) {}
+
+        void SkipFree() {
+            while (index_ < map_->capacity_ && map_->ctrl()[index_] < 0) {
+                index_++;
+            }
+        }
+
+        const RelHashMap *map_;
+        size_t index_;
+
+        friend class RelHashMap;
+    };
+
+    typedef Iterator<value_type> iterator;
+    typedef Iterator<const value_type> const_iterator;
+
+    RelHashMap()
+            : ctrl_(nullptr),
+              slots_(nullptr),
+              capacity_(0),
+              size_(0),
+              growth_left_(0) {}
+
+    /// Create a map with room for `count` entries.
+    explicit RelHashMap(size_t count) : RelHashMap() { reserve(count); }
+
+    RelHashMap(RelHashMap &&other) : RelHashMap() { swap(other); }
+
+    RelHashMap &operator=(RelHashMap &&other) {
+        swap(other);
+        return *this;
+    }
+
+    // not copyable, like RelVector
+    RelHashMap(const RelHashMap &) = delete;
+
+    RelHashMap &operator=(const RelHashMap &) = delete;
+
+    ~RelHashMap() {
+        clear();
+        Deallocate(ctrl(), slots(), capacity_);
+    }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    /// Number of slots (including empty ones).
+    size_t capacity() const { return capacity_; }
+
+    iterator begin() {
+        iterator it(this, 0);
+        it.SkipFree();
+        return it;
+    }
+
+    iterator end() { return iterator(this, capacity_); }
+
+    const_iterator begin() const {
+        const_iterator it(this, 0);
+        it.SkipFree();
+        return it;
+    }
+
+    const_iterator end() const { return const_iterator(this, capacity_); }
+
+    iterator find(const K &key) { return iterator(this, Find(key)); }
+
+    const_iterator find(const K &key) const {
+        return const_iterator(this, Find(key));
+    }
+
+    bool contains(const K &key) const { return Find(key) != capacity_; }
+
+    /// @brief Get the value for a key, inserting a value-initialized one
+    /// if it's missing.
+    V &operator[](const K &key) { return emplace(key).first->second; }
+
+    /// @brief Insert a key/value pair (unless the key is already present).
+    /// @return the key's entry, and whether it was inserted.
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(const K &key, Args &&... args) {
+        const size_t hash = HashOf(key);
+        size_t index = Find(key, hash);
+        if (index != capacity_) {
+            return {iterator(this, index), false};
+        }
+        index = PrepareInsert(hash);
+        ::new (&slots()[index])
+                value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+        return {iterator(this, index), true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type &entry) {
+        return emplace(entry.first, entry.second);
+    }
+
+    /// @brief Insert many entries, growing the table (at most) once.
+    /// @param[in] entries Pairs of keys and values.
+    /// @param[in] count The number of pairs.
+    template <typename E>
+    void InsertAll(const E *entries, size_t count) {
+        reserve(size_ + count);
+        for (size_t i = 0; i < count; i++) {
+            emplace(entries[i].first, entries[i].second);
+        }
+    }
+
+    /// @brief Insert the key/value pairs stored in a list of datablocks.
+    ///
+    /// Each datablock holds one pair (with `first` and `second` fields),
+    /// e.g., the records passed to a task as its VarArgs.
+    template <typename E, size_t N>
+    void InsertAll(const DatablockList<E, N> &dbs) {
+        reserve(size_ + dbs.count());
+        for (auto db : dbs) {
+            emplace(db->first, db->second);
+        }
+    }
+
+    /// @return the number of entries removed (0 or 1)
+    size_t erase(const K &key) {
+        const size_t index = Find(key);
+        if (index == capacity_) return 0;
+        slots()[index].~value_type();
+        // Only mark the slot as empty if no probe could have passed over
+        // it, i.e., if its group (starting here or ending here) has an
+        // empty slot. Otherwise, lookups must keep probing past it.
+        const size_t before = (index - internal::hashing::kGroupWidth) & mask();
+        const u32 empty_after =
+                internal::hashing::ProbeGroup(&ctrl()[index]).MatchEmpty();
+        const u32 empty_before =
+                internal::hashing::ProbeGroup(&ctrl()[before]).MatchEmpty();
+        const bool was_never_full =
+                empty_after && empty_before &&
+                internal::hashing::TrailingZeros(empty_after) +
+                                internal::hashing::LeadingZeros(empty_before) <
+                        static_cast<int>(internal::hashing::kGroupWidth);
+        if (was_never_full) {
+            SetCtrl(index, internal::hashing::kEmpty);
+            growth_left_++;
+        } else {
+            SetCtrl(index, internal::hashing::kDeleted);
+        }
+        size_--;
+        return 1;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < capacity_; i++) {
+            if (ctrl()[i] >= 0) {
+                slots()[i].~value_type();
+            }
+        }
+        // also drop the tombstones, or the table could fill up completely
+        // (leaving no empty slot to end a probe) without growing
+        if (capacity_ > 0) {
+            for (size_t i = 0; i < capacity_ + internal::hashing::kGroupWidth;
+                 i++) {
+                ctrl()[i] = internal::hashing::kEmpty;
+            }
+        }
+        size_ = 0;
+        growth_left_ = MaxLoad(capacity_);
+    }
+
+    /// Make room for `count` entries (without growing again).
+    void reserve(size_t count) {
+        size_t capacity = internal::hashing::kGroupWidth;
+        while (MaxLoad(capacity) < count) {
+            capacity *= 2;
+        }
+        if (capacity > capacity_) {
+            Resize(capacity);
+        }
+    }
+
+    void swap(RelHashMap &other) {
+        int8_t *other_ctrl = other.ctrl();
+        value_type *other_slots = other.slots();
+        other.ctrl_ = ctrl();
+        other.slots_ = slots();
+        ctrl_ = other_ctrl;
+        slots_ = other_slots;
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+    }
+
+ private:
+    // at most 7/8 of the slots are used
+    static size_t MaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+    static size_t HashOf(const K &key) {
+        // mix the bits, since std::hash is often the identity function
+        const u64 hash = static_cast<u64>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    // "H1" picks the first group to probe, and "H2" goes in the ctrl byte
+    static size_t H1(size_t hash) { return hash >> 7; }
+
+    static int8_t H2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    int8_t *ctrl() const { return ctrl_; }
+
+    value_type *slots() const { return slots_; }
+
+    size_t mask() const { return capacity_ - 1; }
+
+    // The control array has a copy of its first group after the end, so
+    // that any group of kGroupWidth bytes can be loaded without wrapping.
+    void SetCtrl(size_t index, int8_t value) {
+        ctrl()[index] = value;
+        if (index < internal::hashing::kGroupWidth) {
+            ctrl()[capacity_ + index] = value;
+        }
+    }
+
+    size_t Find(const K &key) const { return Find(key, HashOf(key)); }
+
+    // Index of the key's slot (or capacity_ if it's missing)
+    size_t Find(const K &key, size_t hash) const {
+        if (capacity_ == 0) return 0;
+        const int8_t h2 = H2(hash);
+        size_t offset = H1(hash) & mask();
+        size_t step = 0;
+        for (;;) {
+            internal::hashing::ProbeGroup group(&ctrl()[offset]);
+            for (u32 match = group.Match(h2); match; match &= match - 1) {
+                const size_t index =
+                        (offset + internal::hashing::TrailingZeros(match)) &
+                        mask();
+                if (slots()[index].first == key) return index;
+            }
+            if (group.MatchEmpty()) return capacity_;
+            // triangular probing visits every group
+            step += internal::hashing::kGroupWidth;
+            offset = (offset + step) & mask();
+        }
+    }
+
+    // First free slot in the probe sequence for a hash
+    size_t FindFree(size_t hash) const {
+        size_t offset = H1(hash) & mask();
+        size_t step = 0;
+        for (;;) {
+            internal::hashing::ProbeGroup group(&ctrl()[offset]);
+            const u32 free = group.MatchFree();
+            if (free) {
+                return (offset + internal::hashing::TrailingZeros(free)) &
+                       mask();
+            }
+            step += internal::hashing::kGroupWidth;
+            offset = (offset + step) & mask();
+        }
+    }
+
+    // Claim a slot for a new entry with the given hash
+    size_t PrepareInsert(size_t hash) {
+        size_t index = capacity_ ? FindFree(hash) : 0;
+        const bool reuse_deleted =
+                capacity_ > 0 && ctrl()[index] == internal::hashing::kDeleted;
+        if (capacity_ == 0 || (growth_left_ == 0 && !reuse_deleted)) {
+            // grow (or, if there are many deleted slots, just clean up)
+            const bool mostly_deleted = size_ <= MaxLoad(capacity_) / 2;
+            Resize(capacity_ == 0 ? internal::hashing::kGroupWidth
+                                  : mostly_deleted ? capacity_
+                                                   : 2 * capacity_);
+            index = FindFree(hash);
+        }
+        if (ctrl()[index] == internal::hashing::kEmpty) {
+            growth_left_--;
+        }
+        SetCtrl(index, H2(hash));
+        size_++;
+        return index;
+    }
+
+    static int8_t *AllocateCtrl(size_t capacity) {
+        auto arena = internal::dballoc::AllocatorGet();
+        return static_cast<int8_t *>(arena.allocate(
+                1, capacity + internal::hashing::kGroupWidth, 16));
+    }
+
+    static value_type *AllocateSlots(size_t capacity) {
+        auto arena = internal::dballoc::AllocatorGet();
+        return static_cast<value_type *>(arena.allocate(
+                sizeof(value_type), capacity, alignof(value_type)));
+    }
+
+    static void Deallocate(int8_t *ctrl, value_type *slots, size_t capacity) {
+        if (capacity > 0) {
+            internal::dballoc::DeallocateInImplicitArena(
+                    ctrl, 1, capacity + internal::hashing::kGroupWidth);
+            internal::dballoc::DeallocateInImplicitArena(
+                    slots, sizeof(value_type), capacity);
+        }
+    }
+
+    // Move the entries into new arrays with the given capacity
+    void Resize(size_t capacity) {
+        int8_t *const old_ctrl = ctrl();
+        value_type *const old_slots = slots();
+        const size_t old_capacity = capacity_;
+        ctrl_ = AllocateCtrl(capacity);
+        slots_ = AllocateSlots(capacity);
+        capacity_ = capacity;
+        for (size_t i = 0; i < capacity + internal::hashing::kGroupWidth;
+             i++) {
+            ctrl()[i] = internal::hashing::kEmpty;
+        }
+        growth_left_ = MaxLoad(capacity) - size_;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_ctrl[i] >= 0) {
+                const size_t hash = HashOf(old_slots[i].first);
+                const size_t index = FindFree(hash);
+                SetCtrl(index, H2(hash));
+                ::new (&slots()[index]) value_type(std::move(old_slots[i]));
+                old_slots[i].~value_type();
+            }
+        }
+        Deallocate(old_ctrl, old_slots, old_capacity);
+    }
+
+    RelPtr<int8_t> ctrl_;
+    RelPtr<value_type> slots_;
+    size_t capacity_;
+    size_t size_;
+    size_t growth_left_;
+
+    friend struct PointerFields<RelHashMap>;
+};
+
+/// Arena#Compact support for RelHashMap (see the RelHashMap notes).
+template <typename K, typename V, typename Hash>
+struct PointerFields<RelHashMap<K, V, Hash>> {
+    template <typename M>
+    static void Visit(RelHashMap<K, V, Hash> &map, M &visitor) {
+        if (map.capacity_ > 0) {
+            visitor(map.ctrl_,
+                    map.capacity_ + internal::hashing::kGroupWidth);
+            visitor(map.slots_, map.capacity_, 0);
+        }
+    }
+};
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_REL_HASH_MAP_HPP_
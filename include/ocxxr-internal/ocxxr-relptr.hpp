@@ -1,18 +1,65 @@
 #ifndef OCXXR_RELPTR_HPP_
 #define OCXXR_RELPTR_HPP_
 
+#include <iterator>
+#include <type_traits>
+
 namespace ocxxr {
 
+namespace internal {
+class PointerSwizzler;
+
+// Iterator typedefs for a RelPtr, which are only provided when its copies
+// (e.g., an algorithm's local variables) can point anywhere
+template <typename T, bool kIsIterator>
+struct RelPtrIteratorTypes {};
+
+template <typename T>
+struct RelPtrIteratorTypes<T, true> {
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_cv<T>::type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+};
+
+}  // namespace internal
+
 /**
  * This is our "relative pointer" class.
  * You should be able to use it pretty much just like a normal pointer.
  * However, you still need to be careful to only point to memory within
  * the same datablock. Nothing keeps you from creating a "relative pointer"
  * into another datablock, or even into the stack.
+ *
+ * Relative pointers support pointer arithmetic, and work as random-access
+ * iterators (e.g., with std::sort), for walking arrays in the datablock.
+ * Arithmetic just adjusts the stored offset, and dereferencing or indexing
+ * skips the null check, so an indexed loop over a RelPtr compiles to the
+ * same (vectorizable) code as a raw pointer loop.
+ * Comparisons and differences go through the conversion to `T *`, which
+ * does check for null.
+ *
+ * The offset is stored as an OffsetT, which can be narrowed (see RelPtr32
+ * and RelPtr16) to save space in pointer-heavy structures, as long as the
+ * target is always close enough. Offsets that don't fit fail an ASSERT.
+ * A narrow RelPtr can't be copied onto the stack (too far from its target),
+ * so it isn't an iterator, and `p + n`, `p - n`, `p++` and `p--` return
+ * plain `T *` values; use those (or `get()`) with standard algorithms.
  */
-template <typename T>
-class RelPtr {
+template <typename T, typename OffsetT = ptrdiff_t>
+class RelPtr : public internal::RelPtrIteratorTypes<
+                       T, sizeof(OffsetT) == sizeof(ptrdiff_t)> {
+    static_assert(std::is_integral<OffsetT>::value &&
+                          std::is_signed<OffsetT>::value &&
+                          sizeof(OffsetT) <= sizeof(ptrdiff_t),
+                  "RelPtr offset type must be a signed integer type");
+
  public:
+    /// The result of non-mutating arithmetic (a raw pointer if narrow).
+    typedef typename std::conditional<sizeof(OffsetT) == sizeof(ptrdiff_t),
+                                      RelPtr, T *>::type Result;
+
     // offset of 1 is impossible since this is larger than 1 byte
     constexpr RelPtr() : offset_(1) {}
 
@@ -21,41 +68,81 @@ class RelPtr {
     RelPtr(const T *other) { set(other); }
 
     // TODO - ensure that default assignment operator still works correctly
-    RelPtr<T> &operator=(const RelPtr &other) {
+    RelPtr &operator=(const RelPtr &other) {
         set(other);
         return *this;
     }
 
-    RelPtr<T> &operator=(const T *other) {
+    RelPtr &operator=(const T *other) {
         set(other);
         return *this;
     }
 
-    T &operator*() const { return *get(); }
+    T &operator*() const { return *target(); }
 
-    T *operator->() const { return get(); }
+    T *operator->() const { return target(); }
 
-    T &operator[](const int index) const { return get()[index]; }
+    T &operator[](ptrdiff_t index) const { return target()[index]; }
 
     operator T *() const { return get(); }
 
-    // TODO - implement math operators, like increment and decrement
+    // As with raw pointers, arithmetic on a null pointer is undefined
+
+    RelPtr &operator+=(ptrdiff_t n) {
+        offset_ = Narrow(offset_ + n * static_cast<ptrdiff_t>(sizeof(T)));
+        return *this;
+    }
+
+    RelPtr &operator-=(ptrdiff_t n) { return *this += -n; }
+
+    RelPtr &operator++() { return *this += 1; }
+
+    RelPtr &operator--() { return *this -= 1; }
+
+    Result operator++(int) {
+        Result old(get());
+        *this += 1;
+        return old;
+    }
+
+    Result operator--(int) {
+        Result old(get());
+        *this -= 1;
+        return old;
+    }
+
+    Result operator+(ptrdiff_t n) const { return get() + n; }
+
+    Result operator-(ptrdiff_t n) const { return get() - n; }
 
  private:
-    ptrdiff_t offset_;
+    OffsetT offset_;
 
     ptrdiff_t base_ptr() const { return reinterpret_cast<ptrdiff_t>(this); }
 
+    // Checks that an offset fits in OffsetT (free for full-width offsets)
+    static OffsetT Narrow(ptrdiff_t offset) {
+        const OffsetT narrow = static_cast<OffsetT>(offset);
+        ASSERT(narrow == offset && "RelPtr target is too far away");
+        return narrow;
+    }
+
     void set(const RelPtr &other) { set(other.get()); }
 
     void set(const T *other) {
         if (other == nullptr) {
             offset_ = 0;
         } else {
-            offset_ = reinterpret_cast<ptrdiff_t>(other) - base_ptr();
+            offset_ = Narrow(reinterpret_cast<ptrdiff_t>(other) - base_ptr());
         }
     }
 
+    // Address of the target, which must not be null
+    T *target() const {
+        ASSERT(offset_ != 0 && offset_ != 1);
+        return reinterpret_cast<T *>(base_ptr() + offset_);
+    }
+
     T *get() const {
         ASSERT(offset_ != 1);
         if (offset_ == 0) {
@@ -71,15 +158,31 @@ class RelPtr {
  * This is our "based pointer" class.
  * You should be able to use it pretty much just like a normal pointer.
  * This class is safer than RelPtr, but not as efficient.
+ *
+ * Like RelPtr, this supports pointer arithmetic and works as a
+ * random-access iterator, but every dereference of a pointer into another
+ * datablock looks up that datablock's address, so hot loops should convert
+ * to a raw pointer (or RelPtr) first, or swizzle the whole structure (see
+ * SwizzleScope).
  */
 template <typename T>
 class BasedPtr {
  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_cv<T>::type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+
     constexpr BasedPtr() : target_guid_(ERROR_GUID), offset_(0) {}
 
-    BasedPtr(const BasedPtr &other) { set(other); }
+    BasedPtr(const BasedPtr &other) : target_guid_(NULL_GUID), offset_(0) {
+        set(other);
+    }
 
-    BasedPtr(const T *other) { set(other); }
+    BasedPtr(const T *other) : target_guid_(NULL_GUID), offset_(0) {
+        set(other);
+    }
 
     // TODO - ensure that default assignment operator still works correctly
     // must handle special cases too
@@ -97,11 +200,41 @@ class BasedPtr {
 
     T *operator->() const { return get(); }
 
-    T &operator[](const int index) const { return get()[index]; }
+    T &operator[](ptrdiff_t index) const { return get()[index]; }
 
     operator T *() const { return get(); }
 
-    // TODO - implement math operators, like increment and decrement
+    // As with raw pointers, arithmetic on a null pointer is undefined
+
+    BasedPtr &operator+=(ptrdiff_t n) {
+        offset_ += n * static_cast<ptrdiff_t>(sizeof(T));
+        return *this;
+    }
+
+    BasedPtr &operator-=(ptrdiff_t n) { return *this += -n; }
+
+    BasedPtr &operator++() { return *this += 1; }
+
+    BasedPtr &operator--() { return *this -= 1; }
+
+    BasedPtr operator++(int) {
+        BasedPtr old(*this);
+        *this += 1;
+        return old;
+    }
+
+    BasedPtr operator--(int) {
+        BasedPtr old(*this);
+        *this -= 1;
+        return old;
+    }
+
+    BasedPtr operator+(ptrdiff_t n) const {
+        BasedPtr result(*this);
+        return result += n;
+    }
+
+    BasedPtr operator-(ptrdiff_t n) const { return *this + -n; }
 
  private:
     ocrGuid_t target_guid_;
@@ -109,6 +242,22 @@ class BasedPtr {
 
     ptrdiff_t base_ptr() const { return reinterpret_cast<ptrdiff_t>(this); }
 
+    // Point to the target by its address relative to this pointer, as for
+    // an intra-datablock pointer (only valid while the target's datablock
+    // stays acquired; see SwizzlePointers)
+    void swizzle() {
+        const T *target = get();
+        if (target) {
+            target_guid_ = UNINITIALIZED_GUID;
+            offset_ = reinterpret_cast<ptrdiff_t>(target) - base_ptr();
+        }
+    }
+
+    // Back to the normal (relocatable) form
+    void unswizzle() { set(get()); }
+
+    friend class internal::PointerSwizzler;
+
     void set(const BasedPtr &other) {
         if (ocrGuidIsUninitialized(other.target_guid_)) {
             set(other.get());
@@ -138,38 +287,180 @@ class BasedPtr {
     }
 };
 
+/**
+ * A compact based pointer, for structures spread over several datablocks.
+ *
+ * Rather than a GUID and a full offset, this stores an index into the GUID
+ * table of the implicit arena (see ArenaMode::kGuidTable) and a 32-bit
+ * offset, so it's only 8 bytes (vs. 16 or more for a BasedPtr). Each task
+ * looks up the address of each datablock in the table at most once, so
+ * following a pointer is an O(1) array lookup. The encoding doesn't depend
+ * on where the pointer is stored, so copying one is a plain copy.
+ * Assigning a raw pointer finds the target's datablock, and adds it to the
+ * table if necessary.
+ *
+ * Tasks that use these pointers must make the arena holding the table
+ * their implicit arena (see SetImplicitArena), and must acquire the
+ * datablocks being pointed into (e.g., the arena's Chain).
+ */
+template <typename T>
+class CompactBasedPtr {
+ public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_cv<T>::type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+
+    constexpr CompactBasedPtr() : index_(kUninitialized), offset_(0) {}
+
+    CompactBasedPtr(const T *other) { set(other); }
+
+    CompactBasedPtr &operator=(const T *other) {
+        set(other);
+        return *this;
+    }
+
+    T &operator*() const { return *get(); }
+
+    T *operator->() const { return get(); }
+
+    T &operator[](ptrdiff_t index) const { return get()[index]; }
+
+    operator T *() const { return get(); }
+
+    // As with raw pointers, arithmetic on a null pointer is undefined
+
+    CompactBasedPtr &operator+=(ptrdiff_t n) {
+        offset_ = Narrow(offset_ + n * static_cast<ptrdiff_t>(sizeof(T)));
+        return *this;
+    }
+
+    CompactBasedPtr &operator-=(ptrdiff_t n) { return *this += -n; }
+
+    CompactBasedPtr &operator++() { return *this += 1; }
+
+    CompactBasedPtr &operator--() { return *this -= 1; }
+
+    CompactBasedPtr operator++(int) {
+        CompactBasedPtr old(*this);
+        *this += 1;
+        return old;
+    }
+
+    CompactBasedPtr operator--(int) {
+        CompactBasedPtr old(*this);
+        *this -= 1;
+        return old;
+    }
+
+    CompactBasedPtr operator+(ptrdiff_t n) const {
+        CompactBasedPtr result(*this);
+        return result += n;
+    }
+
+    CompactBasedPtr operator-(ptrdiff_t n) const { return *this + -n; }
+
+ private:
+    static constexpr u32 kNull = ~static_cast<u32>(0);
+    static constexpr u32 kUninitialized = kNull - 1;
+
+    u32 index_;
+    s32 offset_;
+
+    static s32 Narrow(ptrdiff_t offset) {
+        const s32 narrow = static_cast<s32>(offset);
+        ASSERT(narrow == offset && "Datablock is too big for CompactBasedPtr");
+        return narrow;
+    }
+
+    void set(const T *other) {
+        if (other == nullptr) {
+            index_ = kNull;
+            offset_ = 0;
+        } else {
+            ptrdiff_t offset;
+            index_ = internal::GuidTableIndexForAddress(other, &offset);
+            offset_ = Narrow(offset);
+        }
+    }
+
+    T *get() const {
+        ASSERT(index_ != kUninitialized);
+        if (index_ == kNull) {
+            return nullptr;
+        } else {
+            ptrdiff_t target = internal::GuidTableBase(index_) + offset_;
+            return reinterpret_cast<T *>(target);
+        }
+    }
+};
+
+template <typename T, typename OffsetT>
+typename RelPtr<T, OffsetT>::Result operator+(ptrdiff_t n,
+                                              const RelPtr<T, OffsetT> &ptr) {
+    return ptr + n;
+}
+
+template <typename T>
+BasedPtr<T> operator+(ptrdiff_t n, const BasedPtr<T> &ptr) {
+    return ptr + n;
+}
+
+template <typename T>
+CompactBasedPtr<T> operator+(ptrdiff_t n, const CompactBasedPtr<T> &ptr) {
+    return ptr + n;
+}
+
+/// Relative pointer with a 32-bit offset (for targets within +/-2GB).
+template <typename T>
+using RelPtr32 = RelPtr<T, s32>;
+
+/// Relative pointer with a 16-bit offset (for targets within +/-32KB).
+template <typename T>
+using RelPtr16 = RelPtr<T, s16>;
+
 namespace internal {
 
-template <typename T, unsigned N, template <typename> class P = RelPtr>
+// Fixes the offset type, so RelPtr can be passed as a one-parameter template
+template <typename OffsetT>
+struct RelPtrWithOffset {
+    template <typename T>
+    using Type = RelPtr<T, OffsetT>;
+};
+
+template <typename T, unsigned N, template <typename...> class P = RelPtr>
 struct PointerNester {
     typedef P<typename PointerNester<T, N - 1, P>::Type> Type;
 };
 
-template <typename T, template <typename> class P>
+template <typename T, template <typename...> class P>
 struct PointerNester<T, 0, P> {
     typedef T Type;
 };
 
-template <typename T, template <typename> class P = RelPtr>
+template <typename T, template <typename...> class P = RelPtr>
 struct PointerConvertor;
 
-template <typename T, template <typename> class P>
+template <typename T, template <typename...> class P>
 struct PointerConvertor<T *, P> {
     typedef P<T> Type;
 };
 
-template <typename T, template <typename> class P>
+template <typename T, template <typename...> class P>
 struct PointerConvertor<T **, P> {
     typedef P<typename PointerConvertor<T *, P>::Type> Type;
 };
 
 }  // namespace internal
 
-template <typename T, unsigned N>
-using NestedRelPtr = typename internal::PointerNester<T, N>::Type;
+template <typename T, unsigned N, typename OffsetT = ptrdiff_t>
+using NestedRelPtr = typename internal::PointerNester<
+        T, N, internal::RelPtrWithOffset<OffsetT>::template Type>::Type;
 
-template <typename T>
-using RelPtrFor = typename internal::PointerConvertor<T>::Type;
+template <typename T, typename OffsetT = ptrdiff_t>
+using RelPtrFor = typename internal::PointerConvertor<
+        T, internal::RelPtrWithOffset<OffsetT>::template Type>::Type;
 
 template <typename T, unsigned N>
 using NestedBasedPtr = typename internal::PointerNester<T, N, BasedPtr>::Type;
@@ -0,0 +1,309 @@
+#ifndef OCXXR_SOA_HPP_
+#define OCXXR_SOA_HPP_
+/// @file
+
+#include <tuple>
+
+namespace ocxxr {
+
+/**
+ * A fixed-size table of records stored as a struct of arrays: each field
+ * is a separate column, so a kernel that only reads or writes a few fields
+ * streams through just those columns (and can be vectorized).
+ *
+ * Like RelVector, the columns are allocated from the current implicit
+ * arena (see SetImplicitArena), and are held by relative pointers, so an
+ * SoA stored in the same arena stays valid when the datablock is copied
+ * or moved. The columns are only freed if that arena is still the
+ * implicit arena when the SoA is destroyed. Each column starts on a cache
+ * line (OCXXR_CACHE_LINE_SIZE); as with NewAligned, moving the datablock
+ * only preserves its own alignment. (In an ArenaMode::kFreeList arena,
+ * the columns of a deleted SoA are only reused by allocations that need
+ * at most 16-byte alignment.)
+ *
+ * Indexing gives a proxy that reads and writes the fields in place, so
+ * record-at-a-time code still looks like it's using an array of structs:
+ *
+ *     ocxxr::SoA<float, float, u32> particles(n);   // x, v, id
+ *     particles[i].get<0>() += dt * particles[i].get<1>();
+ *     float *x = particles.column<0>();             // for bulk kernels
+ *
+ * CopyFromAoS and CopyToAoS convert to and from an array of structs. The
+ * field types must be trivially copyable; fields are value-initialized.
+ */
+template <typename... Fields>
+class SoA {
+ public:
+    static constexpr size_t kFieldCount = sizeof...(Fields);
+    static constexpr size_t kColumnAlignment = OCXXR_CACHE_LINE_SIZE;
+
+    static_assert(kFieldCount > 0, "SoA must have at least one field.");
+
+    /// The type of field I.
+    template <size_t I>
+    using Field = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+    /// A copy of one record's fields.
+    typedef std::tuple<Fields...> value_type;
+
+    /**
+     * A reference to one record, which reads and writes its fields in the
+     * columns. Assigning to a proxy assigns the record's values (it
+     * doesn't rebind the proxy).
+     */
+    template <typename S>
+    class Proxy {
+     public:
+        template <size_t I>
+        using FieldRef = typename std::conditional<std::is_const<S>::value,
+                                                   const Field<I> &,
+                                                   Field<I> &>::type;
+
+        Proxy(S *soa, size_t index) : soa_(soa), index_(index) {}
+
+        /// Field I of the record.
+        template <size_t I>
+        FieldRef<I> get() const {
+            return soa_->template column<I>()[index_];
+        }
+
+        /// The record's position in the table.
+        size_t index() const { return index_; }
+
+        operator value_type() const {
+            return Get(internal::MakeIndexSeq<kFieldCount>());
+        }
+
+        const Proxy &operator=(const value_type &values) const {
+            Set(values, internal::MakeIndexSeq<kFieldCount>());
+            return *this;
+        }
+
+        const Proxy &operator=(const Proxy &other) const {
+            return *this = static_cast<value_type>(other);
+        }
+
+        template <typename T>
+        const Proxy &operator=(const Proxy<T> &other) const {
+            return *this = static_cast<value_type>(other);
+        }
+
+     private:
+        template <size_t... I>
+        value_type Get(internal::IndexSeq<I...>) const {
+            return value_type(get<I>()...);
+        }
+
+        template <size_t... I>
+        void Set(const value_type &values, internal::IndexSeq<I...>) const {
+            const int expand[] = {(get<I>() = std::get<I>(values), 0)...};
+            static_cast<void>(expand);
+        }
+
+        S *soa_;
+        size_t index_;
+    };
+
+    typedef Proxy<SoA> reference;
+    typedef Proxy<const SoA> const_reference;
+
+    /// Iterator over the records' proxies.
+    template <typename S>
+    class Iterator {
+     public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef SoA::value_type value_type;
+        typedef ptrdiff_t difference_type;
+        typedef Proxy<S> reference;
+        typedef void pointer;
+
+        Iterator(S *soa, size_t index) : soa_(soa), index_(index) {}
+
+        Proxy<S> operator*() const { return Proxy<S>(soa_, index_); }
+
+        Iterator &operator++() {
+            index_++;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            index_++;
+            return old;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return index_ != other.index_;
+        }
+
+     private:
+        S *soa_;
+        size_t index_;
+    };
+
+    typedef Iterator<SoA> iterator;
+    typedef Iterator<const SoA> const_iterator;
+
+    /// Create a table of `size` value-initialized records.
+    explicit SoA(size_t size) : size_(size) {
+        Allocate(internal::MakeIndexSeq<kFieldCount>());
+    }
+
+    // not copyable, like RelVector
+    SoA(const SoA &) = delete;
+
+    SoA &operator=(const SoA &) = delete;
+
+    ~SoA() { Deallocate(internal::MakeIndexSeq<kFieldCount>()); }
+
+    /// Number of records.
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    /// The column holding field I (for bulk or vectorized kernels).
+    template <size_t I>
+    Field<I> *column() {
+        return std::get<I>(columns_);
+    }
+
+    template <size_t I>
+    const Field<I> *column() const {
+        return std::get<I>(columns_);
+    }
+
+    reference operator[](size_t index) {
+        ASSERT(index < size_ && "SoA index out of bounds");
+        return reference(this, index);
+    }
+
+    const_reference operator[](size_t index) const {
+        ASSERT(index < size_ && "SoA index out of bounds");
+        return const_reference(this, index);
+    }
+
+    iterator begin() { return iterator(this, 0); }
+
+    iterator end() { return iterator(this, size_); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    /// @brief Copy records from an array of structs into the first `count`
+    ///        records, one column at a time.
+    /// @param[in] members Pointers to the struct's members holding each
+    ///                    field, in order, e.g., `&Particle::x`.
+    template <typename R>
+    void CopyFromAoS(const R *records, size_t count, Fields R::*... members) {
+        ASSERT(count <= size_ && "SoA is too small for the records");
+        CopyFrom(records, count, std::make_tuple(members...),
+                 internal::MakeIndexSeq<kFieldCount>());
+    }
+
+    /// @brief Copy the first `count` records out to an array of structs,
+    ///        one column at a time (see CopyFromAoS).
+    template <typename R>
+    void CopyToAoS(R *records, size_t count, Fields R::*... members) const {
+        ASSERT(count <= size_ && "SoA has fewer records than requested");
+        CopyTo(records, count, std::make_tuple(members...),
+               internal::MakeIndexSeq<kFieldCount>());
+    }
+
+ private:
+    template <size_t... I>
+    void Allocate(internal::IndexSeq<I...>) {
+        const int expand[] = {(AllocateColumn<I>(), 0)...};
+        static_cast<void>(expand);
+    }
+
+    template <size_t I>
+    void AllocateColumn() {
+        typedef Field<I> F;
+        static_assert(internal::IsTriviallyCopyable<F>::value,
+                      "SoA fields must be trivially copyable.");
+        auto arena = internal::dballoc::AllocatorGet();
+        F *data = static_cast<F *>(
+                arena.allocate(sizeof(F), size_, kColumnAlignment));
+        for (size_t i = 0; i < size_; i++) {
+            ::new (data + i) F();
+        }
+        std::get<I>(columns_) = data;
+    }
+
+    template <size_t... I>
+    void Deallocate(internal::IndexSeq<I...>) {
+        const int expand[] = {(internal::dballoc::DeallocateInImplicitArena(
+                                       column<I>(), sizeof(Field<I>), size_),
+                               0)...};
+        static_cast<void>(expand);
+    }
+
+    template <typename R, typename M, size_t... I>
+    void CopyFrom(const R *records, size_t count, const M &members,
+                  internal::IndexSeq<I...>) {
+        const int expand[] = {
+                (CopyColumnFrom(column<I>(), records, count,
+                                std::get<I>(members)),
+                 0)...};
+        static_cast<void>(expand);
+    }
+
+    template <typename R, typename M, size_t... I>
+    void CopyTo(R *records, size_t count, const M &members,
+                internal::IndexSeq<I...>) const {
+        const int expand[] = {(CopyColumnTo(column<I>(), records, count,
+                                            std::get<I>(members)),
+                               0)...};
+        static_cast<void>(expand);
+    }
+
+    template <typename F, typename R>
+    static void CopyColumnFrom(F *column, const R *records, size_t count,
+                               F R::*member) {
+        for (size_t i = 0; i < count; i++) {
+            column[i] = records[i].*member;
+        }
+    }
+
+    template <typename F, typename R>
+    static void CopyColumnTo(const F *column, R *records, size_t count,
+                             F R::*member) {
+        for (size_t i = 0; i < count; i++) {
+            records[i].*member = column[i];
+        }
+    }
+
+    std::tuple<RelPtr<Fields>...> columns_;
+    size_t size_;
+
+    friend struct PointerFields<SoA>;
+};
+
+/// Arena#Compact support for SoA (the copied columns keep only the
+/// alignment of their field types).
+template <typename... Fields>
+struct PointerFields<SoA<Fields...>> {
+    template <typename V>
+    static void Visit(SoA<Fields...> &soa, V &visitor) {
+        VisitColumns(soa, visitor,
+                     internal::MakeIndexSeq<sizeof...(Fields)>());
+    }
+
+ private:
+    template <typename V, size_t... I>
+    static void VisitColumns(SoA<Fields...> &soa, V &visitor,
+                             internal::IndexSeq<I...>) {
+        const int expand[] = {
+                (visitor(std::get<I>(soa.columns_), soa.size_), 0)...};
+        static_cast<void>(expand);
+    }
+};
+
+}  // namespace ocxxr
+
+#endif  // OCXXR_SOA_HPP_
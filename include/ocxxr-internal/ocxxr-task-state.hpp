@@ -1,9 +1,7 @@
 #ifndef OCXXR_TASK_STATE_HPP_
 #define OCXXR_TASK_STATE_HPP_
 
-#include <algorithm>
 #include <cstddef>
-#include <limits>
 
 #ifdef __APPLE__
 // For some reason they don't support the standard C++ thread_local,
@@ -20,91 +18,98 @@ namespace internal {
 // Task-local state
 //===============================================
 
-namespace bookkeeping {
-
-class DbPair {
- public:
-    DbPair() = default;
-
-    DbPair(ocrGuid_t guid, ptrdiff_t base_addr)
-            : guid_(guid), base_addr_(base_addr) {}
-
-    DbPair(ocrGuid_t guid, void *base_addr)
-            : DbPair(guid, reinterpret_cast<ptrdiff_t>(base_addr)) {}
+// Base addresses of the datablocks in an arena's GUID table (for
+// CompactBasedPtr), filled in as they're first needed by the task
+struct GuidTableBases {
+    const dballoc::DbArenaHeader *head;  // arena these are for (or nullptr)
+    u32 count;                           // number of entries in bases
+    ptrdiff_t bases[OCXXR_ARENA_GUID_TABLE_SIZE];  // 0 if not looked up yet
 
-    explicit DbPair(ocrGuid_t guid) : DbPair(guid, nullptr) {}
-    explicit DbPair(ptrdiff_t base_addr) : DbPair(ERROR_GUID, base_addr) {}
+    GuidTableBases() : head(nullptr), count(0) {}
 
-    static bool CompareGuids(const DbPair &a, const DbPair &b) {
-        return ocrGuidIsLt(a.guid_, b.guid_);
-    }
-
-    static bool CompareBases(const DbPair &a, const DbPair &b) {
-        return a.base_addr_ < b.base_addr_;
+    // Catch up with the GUID table of the given arena
+    void Sync(dballoc::DbArenaHeader *arena) {
+        if (arena != head) {
+            head = arena;
+            count = 0;
+        }
+        const u32 table_count = dballoc::GuidTableOf(arena).count;
+        for (u32 i = count; i < table_count; i++) {
+            bases[i] = 0;
+        }
+        if (count == 0) bases[0] = reinterpret_cast<ptrdiff_t>(arena);
+        count = table_count;
     }
-
-    ocrGuid_t guid() const { return guid_; }
-
-    ptrdiff_t base_addr() const { return base_addr_; }
-
- private:
-    ocrGuid_t guid_;
-    ptrdiff_t base_addr_;
 };
 
-#ifndef OCXXR_MAX_DB_ACQUIRE_COUNT
-#define OCXXR_MAX_DB_ACQUIRE_COUNT 256
-#endif
-
-struct AcquiredDbInfo {
-    u32 acquired_db_count;
-
-    // TODO - make these arrays more flexible (currently fixed at 256 slots)
-    // this is also currently very inefficient (lots of resorting),
-    // so I should really just re-implement this with a better data structure,
-    // e.g., a splay tree
-
-    DbPair dbs_by_guid[OCXXR_MAX_DB_ACQUIRE_COUNT];  // sorted by guid
-    DbPair dbs_by_addr[OCXXR_MAX_DB_ACQUIRE_COUNT];  // sorted by base address
-
-    DbPair *dbs_by_guid_start() { return &dbs_by_guid[0]; }
-
-    DbPair *dbs_by_guid_end() { return &dbs_by_guid[acquired_db_count]; }
-
-    DbPair *dbs_by_addr_start() { return &dbs_by_addr[0]; }
-
-    DbPair *dbs_by_addr_end() { return &dbs_by_addr[acquired_db_count]; }
-};
-
-}  // namespace bookkeeping
-
 struct TaskLocalState {
     bookkeeping::AcquiredDbInfo acquired_dbs;
     dballoc::DatablockAllocator arena_allocator;
+    GuidTableBases guid_bases;
     TaskLocalState *parent;
+    // task dependences not yet added to acquired_dbs (see DeferDatablocks)
+    const ocrEdtDep_t *pending_depv;
+    u32 pending_depc;
+    // false if the task's policy opted out of datablock bookkeeping
+    bool track_datablocks;
+
+    TaskLocalState()
+            : parent(nullptr),
+              pending_depv(nullptr),
+              pending_depc(0),
+              track_datablocks(true) {}
+
+    // Get ready for reuse by another task
+    void Reset() {
+        acquired_dbs.Clear();
+        ::new (&arena_allocator) dballoc::DatablockAllocator();
+        guid_bases.head = nullptr;
+        parent = nullptr;
+        pending_depv = nullptr;
+    }
 };
 
 // defined in ocxxr-define-once.inc
 extern OCXXR_THREAD_LOCAL TaskLocalState *_task_local_state;
 
+// Per-worker pool of idle task states (linked through TaskLocalState::parent).
+// defined in ocxxr-define-once.inc
+extern OCXXR_THREAD_LOCAL TaskLocalState *_task_state_pool;
+
 /* Note: The push/pop task state functions are currently necessary because the
  * Traleika Glacier OCR implementation uses a "work-shifting" strategy to try
  * to do some useful work while an EDT is blocked. This behavior is triggered
  * by legacy blocking constructs, as well as for remote operations in x86-mpi.
  */
 
-inline void PushTaskState() {
+/* Task states are recycled through a per-worker pool rather than being
+ * allocated for each task. A worker only needs a new state when it is nested
+ * deeper (due to work-shifting) than it has ever been before, so in the
+ * steady state launching a task does no heap allocation. Resetting a state
+ * for reuse only touches the bookkeeping slots that the last task used.
+ */
+
+inline void PushTaskState(bool track_datablocks, bool cache_lookups) {
     TaskLocalState *parent_state = _task_local_state;
-    _task_local_state = OCXXR_TEMP_NEW_ZERO(TaskLocalState);
-    bookkeeping::AcquiredDbInfo *db_info = &_task_local_state->acquired_dbs;
-    ASSERT(db_info->acquired_db_count == 0);  // should do zero-init
-    _task_local_state->parent = parent_state;
+    TaskLocalState *state = _task_state_pool;
+    if (state) {
+        _task_state_pool = state->parent;
+    } else {
+        state = OCXXR_TEMP_NEW(TaskLocalState);
+    }
+    ASSERT(state->acquired_dbs.count() == 0 && !state->pending_depv);
+    state->parent = parent_state;
+    state->track_datablocks = track_datablocks;
+    state->acquired_dbs.set_caching(cache_lookups);
+    _task_local_state = state;
 }
 
 inline void PopTaskState() {
     TaskLocalState *child_state = _task_local_state;
-    _task_local_state = _task_local_state->parent;
-    OCXXR_TEMP_DELETE(child_state);
+    _task_local_state = child_state->parent;
+    child_state->Reset();
+    child_state->parent = _task_state_pool;
+    _task_state_pool = child_state;
 }
 
 //===============================================
@@ -113,67 +118,64 @@ inline void PopTaskState() {
 
 namespace bookkeeping {
 
+/* A task's dependences are only added to its datablock index the first time
+ * the index is actually needed (e.g., for a BasedPtr, or when a datablock is
+ * acquired or released). Tasks that never touch the index never pay for
+ * building it, and the depv array stays valid for the task's whole lifetime.
+ */
+
+// Get the current task's datablock index (adding any deferred dependences)
+inline AcquiredDbInfo *TrackedDatablocks() {
+    TaskLocalState *state = _task_local_state;
+    if (state->pending_depv) {
+        const ocrEdtDep_t *depv = state->pending_depv;
+        state->pending_depv = nullptr;
+        state->acquired_dbs.InsertAll(state->pending_depc, depv);
+    }
+    return &state->acquired_dbs;
+}
+
+inline void DeferDatablocks(u32 depc, const ocrEdtDep_t depv[]) {
+    TaskLocalState *state = _task_local_state;
+    ASSERT(!state->pending_depv && "Task dependences were already deferred");
+    state->pending_depv = depv;
+    state->pending_depc = depc;
+}
+
 inline void AddDatablock(ocrGuid_t guid, void *base_address) {
     // don't track NULL_GUID
-    if (!base_address) return;
-    bookkeeping::AcquiredDbInfo *db_info = &_task_local_state->acquired_dbs;
-    // don't add duplicate GUIDs
-    auto g_start = db_info->dbs_by_guid_start();
-    auto g_end = db_info->dbs_by_guid_end();
-    if (!std::binary_search(g_start, g_end, DbPair(guid),
-                            DbPair::CompareGuids)) {
-        ASSERT(db_info->acquired_db_count < OCXXR_MAX_DB_ACQUIRE_COUNT &&
-               "Acquired too many datablocks in one task");
-        // OK, this is a new GUID that we should actually track...
-        DbPair new_info(guid, base_address);
-        // add to by_guid array
-        *(g_end++) = new_info;
-        std::sort(g_start, g_end, DbPair::CompareGuids);
-        // add to by_addr array
-        auto a_start = db_info->dbs_by_addr_start();
-        auto a_end = db_info->dbs_by_addr_end();
-        *(a_end++) = new_info;
-        std::sort(a_start, a_end, DbPair::CompareBases);
-        // now we have one more
-        ++db_info->acquired_db_count;
-    }
+    if (!base_address || !_task_local_state->track_datablocks) return;
+    bookkeeping::AcquiredDbInfo *db_info = TrackedDatablocks();
+    // duplicate GUIDs are ignored by the index
+    db_info->Insert(guid, reinterpret_cast<ptrdiff_t>(base_address));
+}
+
+inline void AddDatablocks(u32 depc, const ocrEdtDep_t depv[]) {
+    bookkeeping::AcquiredDbInfo *db_info = TrackedDatablocks();
+    db_info->InsertAll(depc, depv);
 }
 
 inline void RemoveDatablock(ocrGuid_t guid) {
     if (ocrGuidIsNull(guid)) return;
-    bookkeeping::AcquiredDbInfo *db_info = &_task_local_state->acquired_dbs;
-    auto g_start = db_info->dbs_by_guid_start();
-    auto g_end = db_info->dbs_by_guid_end();
-    auto i = std::lower_bound(g_start, g_end, DbPair(guid),
-                              DbPair::CompareGuids);
-    ASSERT(ocrGuidIsEq(guid, i->guid()) &&
-           "Released untracked non-null datablock");
-    ptrdiff_t base_addr = i->base_addr();
-    std::swap(i, --g_end);
-    std::sort(g_start, g_end, DbPair::CompareGuids);
-    auto a_start = db_info->dbs_by_addr_start();
-    auto a_end = db_info->dbs_by_addr_end();
-    auto j = std::lower_bound(a_start, a_end, DbPair(base_addr),
-                              DbPair::CompareBases);
-    ASSERT(base_addr == j->base_addr() &&
-           "Matching base address for datablock GUID not found");
-    std::swap(j, --a_end);
-    std::sort(a_start, a_end, DbPair::CompareBases);
+    // the datablock may be in a GUID table, so look the bases up again
+    _task_local_state->guid_bases.head = nullptr;
+    if (!_task_local_state->track_datablocks) return;
+    bookkeeping::AcquiredDbInfo *db_info = TrackedDatablocks();
+    ptrdiff_t base_addr = db_info->Remove(guid);
+    static_cast<void>(base_addr);  // unused if asserts are disabled
+    ASSERT(base_addr != 0 && "Released untracked non-null datablock");
 }
 
 }  // namespace bookkeeping
 
 inline ptrdiff_t AddressForGuid(ocrGuid_t guid) {
-    using bookkeeping::DbPair;
     ASSERT(!ocrGuidIsNull(guid) && "Should not query for NULL_GUID");
-    bookkeeping::AcquiredDbInfo *db_info = &_task_local_state->acquired_dbs;
-    auto g_start = db_info->dbs_by_guid_start();
-    auto g_end = db_info->dbs_by_guid_end();
-    auto i = std::lower_bound(g_start, g_end, DbPair(guid),
-                              DbPair::CompareGuids);
-    ASSERT(i != g_end && "Lookup of untracked non-null datablock");
-    ASSERT(ocrGuidIsEq(guid, i->guid()) && "Datablock lookup mismatch");
-    return i->base_addr();
+    ASSERT(_task_local_state->track_datablocks &&
+           "BasedPtr used in a task without datablock tracking");
+    bookkeeping::AcquiredDbInfo *db_info = bookkeeping::TrackedDatablocks();
+    ptrdiff_t base_addr = db_info->Find(guid);
+    ASSERT(base_addr != 0 && "Lookup of untracked non-null datablock");
+    return base_addr;
 }
 
 inline void GuidOffsetForAddress(const void *target, const void *source,
@@ -187,35 +189,75 @@ inline void GuidOffsetForAddress(const void *target, const void *source,
         *guid_out = NULL_GUID;
         *offset_out = 0;
     } else {
-        // Find closest (<=) base address with binary search
-        bookkeeping::AcquiredDbInfo *db_info = &_task_local_state->acquired_dbs;
-        auto a_start = db_info->dbs_by_addr_start();
-        auto a_end = db_info->dbs_by_addr_end();
+        ASSERT(_task_local_state->track_datablocks &&
+               "BasedPtr used in a task without datablock tracking");
+        // Find closest (<=) base address in the address-ordered index
+        bookkeeping::AcquiredDbInfo *db_info =
+                bookkeeping::TrackedDatablocks();
         ptrdiff_t dst_addr = reinterpret_cast<ptrdiff_t>(target);
         ptrdiff_t src_addr = reinterpret_cast<ptrdiff_t>(source);
-        auto j = std::upper_bound(a_start, a_end, DbPair(dst_addr),
-                                  DbPair::CompareBases);
-        ASSERT(j != a_start);
-        auto i = j - 1;
-        ptrdiff_t end_addr = (j == a_end)
-                                     ? std::numeric_limits<ptrdiff_t>::max()
-                                     : j->base_addr();
-        ASSERT(i != a_end && i->base_addr() <= dst_addr &&
-               dst_addr <= end_addr &&
+        DbPair floor;
+        ptrdiff_t end_addr = 0;
+        bool found = db_info->FindByAddress(dst_addr, &floor, &end_addr);
+        static_cast<void>(found);  // unused if asserts are disabled
+        ASSERT(found && dst_addr <= end_addr &&
                "Based pointer must point into an acquired datablock");
         // output results
-        if (i->base_addr() <= src_addr && src_addr <= end_addr) {
+        if (floor.base_addr() <= src_addr && src_addr <= end_addr) {
             // optimized case: treat as intra-datablock RelPtr
             *guid_out = UNINITIALIZED_GUID;
             *offset_out = dst_addr - src_addr;
         } else {
             // normal case: inter-datablock pointer
-            *guid_out = i->guid();
-            *offset_out = dst_addr - i->base_addr();
+            *guid_out = floor.guid();
+            *offset_out = dst_addr - floor.base_addr();
         }
     }
 }
 
+inline u32 GuidTableIndexForAddress(const void *target,
+                                    ptrdiff_t *offset_out) {
+    dballoc::DbArenaHeader *head = dballoc::AllocatorGet().headBlock();
+    ASSERT(head && (head->mode & ArenaMode::kGuidTable) &&
+           "CompactBasedPtr used without an implicit arena with a GUID table");
+    const ptrdiff_t dst_addr = reinterpret_cast<ptrdiff_t>(target);
+    const ptrdiff_t head_addr = reinterpret_cast<ptrdiff_t>(head);
+    if (head_addr <= dst_addr && dst_addr < head_addr + head->size) {
+        // optimized case: pointing into the arena's first datablock
+        *offset_out = dst_addr - head_addr;
+        return 0;
+    }
+    ASSERT(_task_local_state->track_datablocks &&
+           "CompactBasedPtr used in a task without datablock tracking");
+    bookkeeping::DbPair floor;
+    ptrdiff_t end_addr = 0;
+    bool found = bookkeeping::TrackedDatablocks()->FindByAddress(
+            dst_addr, &floor, &end_addr);
+    static_cast<void>(found);  // unused if asserts are disabled
+    ASSERT(found && dst_addr <= end_addr &&
+           "CompactBasedPtr must point into an acquired datablock");
+    *offset_out = dst_addr - floor.base_addr();
+    return dballoc::GuidTableIndex(head, floor.guid());
+}
+
+inline ptrdiff_t GuidTableBase(u32 index) {
+    GuidTableBases &cache = _task_local_state->guid_bases;
+    dballoc::DbArenaHeader *head = dballoc::AllocatorGet().headBlock();
+    if (cache.head != head || index >= cache.count) {
+        ASSERT(head && (head->mode & ArenaMode::kGuidTable) &&
+               "CompactBasedPtr used without an implicit arena with a GUID "
+               "table");
+        cache.Sync(head);
+        ASSERT(index < cache.count && "CompactBasedPtr index out of range");
+    }
+    ptrdiff_t base = cache.bases[index];
+    if (base == 0) {
+        base = AddressForGuid(dballoc::GuidTableOf(head).guids[index]);
+        cache.bases[index] = base;
+    }
+    return base;
+}
+
 //===============================================
 // Arena support
 //===============================================
@@ -231,6 +273,11 @@ inline void AllocatorSetDb(void *dbPtr) {
     ::new (&_task_local_state->arena_allocator) DatablockAllocator(dbPtr);
 }
 
+/// Restore a saved implicit arena allocator
+inline void AllocatorSet(const DatablockAllocator &allocator) {
+    ::new (&_task_local_state->arena_allocator) DatablockAllocator(allocator);
+}
+
 }  // namespace dballoc
 }  // namespace internal
 }  // namespace ocxxr
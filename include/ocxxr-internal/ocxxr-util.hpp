@@ -81,7 +81,8 @@ struct SizeOf {
 inline void OK(u8 status) { ASSERT(status == 0); }
 
 // defined in ocxxr-task-state.hpp
-inline void PushTaskState();
+inline void PushTaskState(bool track_datablocks = true,
+                          bool cache_lookups = true);
 
 // defined in ocxxr-task-state.hpp
 inline void PopTaskState();
@@ -94,6 +95,12 @@ inline void RemoveDatablock(ocrGuid_t guid);
 // defined in ocxxr-task-state.hpp
 inline void AddDatablock(ocrGuid_t guid, void *base_address);
 
+// defined in ocxxr-task-state.hpp
+inline void AddDatablocks(u32 depc, const ocrEdtDep_t depv[]);
+
+// defined in ocxxr-task-state.hpp
+inline void DeferDatablocks(u32 depc, const ocrEdtDep_t depv[]);
+
 }  // namespace bookkeeping
 
 // defined in ocxxr-task-state.hpp
@@ -103,6 +110,13 @@ inline ptrdiff_t AddressForGuid(ocrGuid_t);
 inline void GuidOffsetForAddress(const void *target, const void *source,
                                  ocrGuid_t *guid_out, ptrdiff_t *offset_out);
 
+// defined in ocxxr-task-state.hpp
+inline u32 GuidTableIndexForAddress(const void *target,
+                                    ptrdiff_t *offset_out);
+
+// defined in ocxxr-task-state.hpp
+inline ptrdiff_t GuidTableBase(u32 index);
+
 }  // namespace internal
 }  // namespace ocxxr
 
@@ -32,10 +32,30 @@ extern "C" {
 
 #include <ocxxr-internal/ocxxr-extension.hpp>
 
+#include <ocxxr-internal/ocxxr-array.hpp>
+
 #include <ocxxr-internal/ocxxr-arena.hpp>
 
 #include <ocxxr-internal/ocxxr-relptr.hpp>
 
+#include <ocxxr-internal/ocxxr-compact.hpp>
+
+#include <ocxxr-internal/ocxxr-swizzle.hpp>
+
+#include <ocxxr-internal/ocxxr-grid.hpp>
+
+#include <ocxxr-internal/ocxxr-arena-file.hpp>
+
+#include <ocxxr-internal/ocxxr-allocator.hpp>
+
+#include <ocxxr-internal/ocxxr-rel-containers.hpp>
+
+#include <ocxxr-internal/ocxxr-soa.hpp>
+
+#include <ocxxr-internal/ocxxr-rel-hash-map.hpp>
+
+#include <ocxxr-internal/ocxxr-db-index.hpp>
+
 #include <ocxxr-internal/ocxxr-task-state.hpp>
 
 /// @brief Convenience macro for creating ocxxr task templates.
@@ -47,4 +67,12 @@ extern "C" {
 #define OCXXR_TEMPLATE_FOR(fn_ptr) \
     ::ocxxr::TaskTemplate<decltype(fn_ptr)>::Create<fn_ptr>();
 
+/// @brief Create a task template for a function, using a task policy.
+/// @see ocxxr::UntrackedTaskPolicy
+///
+/// @param[in] fn_ptr The function's name (see #OCXXR_TEMPLATE_FOR).
+/// @param[in] policy A task policy type, e.g., ocxxr::UntrackedTaskPolicy.
+#define OCXXR_TEMPLATE_WITH_POLICY(fn_ptr, policy) \
+    ::ocxxr::TaskTemplate<decltype(fn_ptr)>::Create<fn_ptr, policy>();
+
 #endif  // OCXXR_HPP_
@@ -0,0 +1,98 @@
+#include <ocxxr-main.hpp>
+
+#include <cstdint>
+
+static constexpr u64 kArenaBytes = 4096;
+
+// e.g., 8 floats for an AVX register
+struct alignas(32) Vec8 {
+    float lanes[8];
+};
+
+struct Root {
+    ocxxr::RelPtr<Vec8> vectors;
+    u32 count;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Root> {
+    template <typename V>
+    static void Visit(Root &root, V &visitor) {
+        visitor(root.vectors, root.count);
+    }
+};
+
+}  // namespace ocxxr
+
+template <typename T>
+bool IsAligned(T *ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+void CheckAllocations(ocxxr::Arena<Root> arena) {
+    // throw off the alignment before each allocation
+    arena.New<char>();
+    Vec8 *vector = arena.New<Vec8>();
+    ASSERT(IsAligned(vector, 32));
+    arena.New<char>();
+    Vec8 *vectors = arena.NewArray<Vec8>(3);
+    ASSERT(IsAligned(vectors, 32) && IsAligned(&vectors[1], 32));
+    arena.New<char>();
+    float *floats = arena.NewAligned<float>(100, 64);
+    ASSERT(IsAligned(floats, 64));
+    arena.New<char>();
+    double *doubles = arena.NewAligned<double>(10, 128);
+    ASSERT(IsAligned(doubles, 128));
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<Root>::Create(kArenaBytes);
+    Root *root = arena.New<Root>();
+    CheckAllocations(arena);
+
+    // Each padded value gets its own cache line
+    ocxxr::SetImplicitArena(arena);
+    ocxxr::New<char>();
+    auto counters = ocxxr::NewArray<ocxxr::CachePadded<u64>>(4);
+    for (u32 i = 0; i < 4; i++) {
+        ASSERT(IsAligned(&counters[i], OCXXR_CACHE_LINE_SIZE));
+        ASSERT(*counters[i] == 0);
+    }
+    ASSERT(reinterpret_cast<char *>(&counters[1]) -
+                   reinterpret_cast<char *>(&counters[0]) ==
+           OCXXR_CACHE_LINE_SIZE);
+    ocxxr::New<char>();
+    char *line = ocxxr::NewCacheAligned<char>(10);
+    ASSERT(IsAligned(line, OCXXR_CACHE_LINE_SIZE));
+
+    // Free-list arenas too
+    auto free_list = ocxxr::Arena<void>::Create(kArenaBytes,
+                                                ocxxr::ArenaMode::kFreeList);
+    free_list.New<char>();
+    Vec8 *vector = free_list.New<Vec8>();
+    ASSERT(IsAligned(vector, 32));
+    free_list.Delete(vector);
+    free_list.New<char>();
+    vector = free_list.New<Vec8>();
+    ASSERT(IsAligned(vector, 32));
+    free_list.Destroy();
+
+    // Compaction keeps the alignment
+    root->count = 5;
+    root->vectors = arena.NewArray<Vec8>(root->count);
+    for (u32 i = 0; i < root->count; i++) {
+        root->vectors[i].lanes[7] = i;
+    }
+    auto compact = arena.Compact();
+    ASSERT(IsAligned(&compact->vectors[0], 32));
+    for (u32 i = 0; i < root->count; i++) {
+        ASSERT(compact->vectors[i].lanes[7] == i);
+    }
+    PRINTF("Aligned allocations OK (compacted arena is %" PRId64 " bytes)\n",
+           compact.size());
+    compact.Destroy();
+    arena.Destroy();
+    ocxxr::Shutdown();
+}
@@ -0,0 +1,92 @@
+#include <ocxxr-main.hpp>
+
+// Much less than the list needs, so the arena has to grow
+static constexpr u64 kInitialBytes = 256;
+static constexpr u32 kLength = 1000;
+
+struct Node {
+    u32 value;
+    ocxxr::BasedPtr<Node> next;
+};
+
+struct List {
+    u32 length;
+    ocxxr::BasedPtr<Node> head;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Node> {
+    template <typename V>
+    static void Visit(Node &node, V &visitor) {
+        visitor(node.next);
+    }
+};
+
+template <>
+struct PointerFields<List> {
+    template <typename V>
+    static void Visit(List &list, V &visitor) {
+        visitor(list.head);
+    }
+};
+
+}  // namespace ocxxr
+
+void PushNodes(ocxxr::Arena<List> arena, u32 count) {
+    List &list = arena.data();
+    for (u32 i = 0; i < count; i++) {
+        Node *node = arena.New<Node>();
+        node->value = list.length++;
+        node->next = list.head;
+        list.head = node;
+    }
+}
+
+void CheckList(ocxxr::Arena<List> arena) {
+    u32 expected = arena->length;
+    for (Node *node = arena->head; node; node = node->next) {
+        expected--;
+        ASSERT(node->value == expected);
+    }
+    ASSERT(expected == 0);
+}
+
+void ChildTask(ocxxr::Arena<List> arena, ocxxr::DatablockList<void> chain) {
+    PRINTF("Child task got a chain of %zu datablocks\n", chain.count());
+    ASSERT(chain.count() == arena.chain_length());
+    CheckList(arena);
+    // keep allocating where the parent left off
+    PushNodes(arena, kLength);
+    ASSERT(arena->length == 2 * kLength);
+    CheckList(arena);
+    PRINTF("Chain grew to %" PRIu32 " datablocks\n", arena.chain_length());
+    // compacting gathers the whole chain into one datablock
+    auto compact = arena.Compact();
+    arena.Destroy();
+    ASSERT(compact.chain_length() == 0);
+    CheckList(compact);
+    compact.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<List>::Create(kInitialBytes,
+                                            ocxxr::ArenaMode::kChained);
+    ocxxr::SetImplicitArena(arena);
+    List *list = ocxxr::New<List>();
+    ASSERT(list == arena.data_ptr());
+    list->length = 0;
+    list->head = nullptr;
+    PushNodes(arena, kLength);
+    PRINTF("Arena grew to %" PRIu32 " chained datablocks\n",
+           arena.chain_length());
+    ASSERT(arena.chain_length() > 0);
+    CheckList(arena);
+    auto chain = arena.Chain();
+    arena.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(arena, chain);
+}
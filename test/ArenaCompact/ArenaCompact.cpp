@@ -0,0 +1,87 @@
+#include <ocxxr-main.hpp>
+#include <cstring>
+
+static constexpr u32 kLength = 100;
+static constexpr u32 kValueCount = 4;
+static constexpr u64 kArenaBytes = 1 << 16;
+
+struct Node {
+    u32 id;
+    ocxxr::RelPtr<double> values;
+    ocxxr::RelPtr<Node> next;
+};
+
+struct List {
+    ocxxr::RelPtr<Node> head;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Node> {
+    template <typename V>
+    static void Visit(Node &node, V &visitor) {
+        visitor(node.values, kValueCount);
+        visitor(node.next);
+    }
+};
+
+template <>
+struct PointerFields<List> {
+    template <typename V>
+    static void Visit(List &list, V &visitor) {
+        visitor(list.head);
+    }
+};
+
+}  // namespace ocxxr
+
+void CheckList(ocxxr::Arena<List> arena) {
+    u32 expected = kLength;
+    for (Node *node = arena->head; node; node = node->next) {
+        expected--;
+        ASSERT(node->id == expected);
+        for (u32 i = 0; i < kValueCount; i++) {
+            ASSERT(node->values[i] == node->id + i / 10.0);
+        }
+    }
+    ASSERT(expected == 0);
+}
+
+void ChildTask(ocxxr::Arena<List> arena) {
+    PRINTF("Checking compacted list in child task\n");
+    CheckList(arena);
+    arena.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<List>::Create(kArenaBytes);
+    List *list = arena.New<List>();
+    list->head = nullptr;
+    for (u32 i = 0; i < kLength; i++) {
+        // temporary garbage between the live objects
+        arena.NewArray<char>(100);
+        Node *node = arena.New<Node>();
+        node->id = i;
+        node->values = arena.NewArray<double>(kValueCount);
+        for (u32 j = 0; j < kValueCount; j++) {
+            node->values[j] = i + j / 10.0;
+        }
+        node->next = list->head;
+        list->head = node;
+    }
+    CheckList(arena);
+    auto compact = arena.Compact();
+    PRINTF("Compacted arena from %" PRId64 " to %" PRId64 " bytes\n",
+           arena.size(), compact.size());
+    ASSERT(compact.size() < arena.size());
+    // the copy must not depend on the original
+    std::memset(arena.base_ptr(), 0, arena.size());
+    arena.Destroy();
+    CheckList(compact);
+    compact.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(compact);
+}
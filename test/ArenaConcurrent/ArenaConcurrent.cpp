@@ -0,0 +1,124 @@
+#include <ocxxr-main.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+static constexpr u64 kArenaBytes = 1 << 20;
+static constexpr u32 kWorkers = 4;
+static constexpr u32 kItems = 1000;
+static constexpr u32 kThreadItems = 10000;
+
+struct Item {
+    u32 worker;
+    u32 value;
+    ocxxr::RelPtr<Item> next;
+};
+
+// Each worker task fills in one of the lists
+struct Result {
+    Result() : done(0) {
+        for (ocxxr::RelPtr<Item> &list : lists) {
+            list = nullptr;
+        }
+    }
+
+    ocxxr::RelPtr<Item> lists[kWorkers];
+    u32 done;
+};
+
+void CheckResult(Result &result) {
+    std::vector<Item *> items;
+    for (u32 w = 0; w < kWorkers; w++) {
+        u32 count = 0;
+        for (Item *item = result.lists[w]; item; item = item->next) {
+            ASSERT(item->worker == w);
+            ASSERT(item->value == kItems - 1 - count);
+            items.push_back(item);
+            count++;
+        }
+        ASSERT(count == kItems);
+    }
+    // no two items overlap
+    std::sort(items.begin(), items.end());
+    for (size_t i = 1; i < items.size(); i++) {
+        ASSERT(items[i - 1] + 1 <= items[i]);
+    }
+}
+
+void WorkerTask(u32 worker, ocxxr::Arena<Result> arena) {
+    Result &result = arena.data();
+    ocxxr::SetImplicitArena(arena);
+    // half of the items are allocated directly from the shared arena,
+    // and half from a private chunk
+    ocxxr::ArenaChunk chunk(arena, sizeof(Item) * kItems / 2);
+    for (u32 i = 0; i < kItems; i++) {
+        Item *item;
+        if (i % 2 == 0) {
+            item = ocxxr::New<Item>();
+        } else {
+            ocxxr::ArenaScope scope(chunk);
+            item = ocxxr::New<Item>();
+        }
+        item->worker = worker;
+        item->value = i;
+        item->next = result.lists[worker];
+        result.lists[worker] = item;
+    }
+    ASSERT(chunk.remaining() == 0);
+    // the last worker to finish checks the result
+    if (__atomic_add_fetch(&result.done, 1, __ATOMIC_ACQ_REL) == kWorkers) {
+        PRINTF("All workers finished\n");
+        CheckResult(result);
+        arena.Destroy();
+        PRINTF("Shutting down...\n");
+        ocxxr::Shutdown();
+    }
+}
+
+// Allocate from several threads at once, checking that no two
+// allocations overlap
+void CheckThreads() {
+    auto arena = ocxxr::Arena<void>::Create(
+            u64{kWorkers} * kThreadItems * 64, ocxxr::ArenaMode::kConcurrent);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<u32 *>> allocated(kWorkers);
+    for (u32 t = 0; t < kWorkers; t++) {
+        threads.emplace_back([&, t] {
+            for (u32 i = 0; i < kThreadItems; i++) {
+                // mix in some over-aligned allocations
+                u32 *values = (i % 16 == 0)
+                                      ? arena.NewAligned<u32>(4, 64)
+                                      : arena.NewArray<u32>(i % 8 + 1);
+                values[0] = t;
+                allocated[t].push_back(values);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (u32 t = 0; t < kWorkers; t++) {
+        for (size_t i = 0; i < allocated[t].size(); i++) {
+            ASSERT(*allocated[t][i] == t);
+            if (i % 16 == 0) {
+                ASSERT(reinterpret_cast<uintptr_t>(allocated[t][i]) % 64 == 0);
+            }
+        }
+    }
+    arena.Destroy();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    CheckThreads();
+
+    auto arena = ocxxr::Arena<Result>::Create(kArenaBytes,
+                                              ocxxr::ArenaMode::kConcurrent);
+    ocxxr::SetImplicitArena(arena);
+    ocxxr::New<Result>();
+    arena.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(WorkerTask);
+    for (u32 w = 0; w < kWorkers; w++) {
+        task_template().CreateTask(w, arena);
+    }
+}
@@ -0,0 +1,100 @@
+#include <ocxxr-main.hpp>
+
+#include <cstdio>
+
+static constexpr u64 kArenaBytes = 64 * 1024;
+static constexpr u32 kPoints = 100;
+static const char kPath[] = "ArenaFile.arena";
+static const char kBadPath[] = "ArenaFile-truncated.arena";
+
+// A preprocessed input, like a mesh with an index
+struct Mesh {
+    ocxxr::RelString name;
+    ocxxr::RelVector<double> points;
+    ocxxr::RelHashMap<u32, u32> index;
+};
+
+void CheckMesh(ocxxr::Arena<Mesh> arena) {
+    ASSERT(!arena.is_null());
+    Mesh &mesh = arena.data();
+    ASSERT(mesh.name == "mesh");
+    ASSERT(mesh.points.size() == kPoints);
+    for (u32 i = 0; i < kPoints; i++) {
+        ASSERT(mesh.points[i] == i * 0.5);
+        ASSERT(mesh.index.find(i * 7)->second == i);
+    }
+}
+
+void ChildTask(ocxxr::Arena<Mesh> arena) {
+    PRINTF("Child task got the loaded mesh\n");
+    CheckMesh(arena);
+    // the loaded arena can still be allocated in
+    ocxxr::SetImplicitArena(arena);
+    arena->points.push_back(-1);
+    arena.Destroy();
+    std::remove(kPath);
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+// Loading the file must fail (without leaking a datablock if it doesn't)
+template <typename T>
+void CheckRejected(const char *path) {
+    auto arena = ocxxr::Arena<T>::LoadFrom(path);
+    ASSERT(arena.is_null());
+    if (!arena.is_null()) arena.Destroy();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    {
+        auto arena = ocxxr::Arena<Mesh>::Create(kArenaBytes);
+        ocxxr::SetImplicitArena(arena);
+        Mesh *mesh = ocxxr::New<Mesh>();
+        mesh->name = "mesh";
+        mesh->index.reserve(kPoints);
+        for (u32 i = 0; i < kPoints; i++) {
+            mesh->points.push_back(i * 0.5);
+            mesh->index[i * 7] = i;
+        }
+        const bool saved = arena.SaveTo(kPath);
+        ASSERT(saved);
+        arena.Destroy();
+    }
+
+    // Only the used part of the arena is saved
+    std::FILE *file = std::fopen(kPath, "rb");
+    ASSERT(file);
+    std::fseek(file, 0, SEEK_END);
+    const long file_bytes = std::ftell(file);
+    ASSERT(file_bytes < static_cast<long>(kArenaBytes / 2));
+
+    // A truncated file is rejected
+    {
+        std::FILE *bad = std::fopen(kBadPath, "wb");
+        ASSERT(bad);
+        char buf[256];
+        std::fseek(file, 0, SEEK_SET);
+        const size_t read = std::fread(buf, 1, sizeof(buf), file);
+        ASSERT(read == sizeof(buf));
+        std::fwrite(buf, 1, sizeof(buf), bad);
+        std::fclose(bad);
+        CheckRejected<Mesh>(kBadPath);
+        std::remove(kBadPath);
+    }
+    std::fclose(file);
+
+    // So is a missing file, or a different root type
+    CheckRejected<Mesh>("no-such-file.arena");
+    CheckRejected<double>(kPath);
+
+    auto loaded = ocxxr::Arena<Mesh>::LoadFrom(kPath);
+    PRINTF("Loaded %" PRId64 "-byte arena from %ld-byte file\n",
+           loaded.size(), file_bytes);
+    ASSERT(loaded.size() ==
+           static_cast<s64>(kArenaBytes + sizeof(ocxxr::ArenaState<Mesh>)));
+    CheckMesh(loaded);
+    loaded.Release();
+
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(loaded);
+}
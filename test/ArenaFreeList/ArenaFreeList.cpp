@@ -0,0 +1,148 @@
+#include <ocxxr-main.hpp>
+
+#include <cstring>
+
+// Much less than the churn loop allocates in total
+static constexpr u64 kArenaBytes = 16 * 1024;
+static constexpr u32 kRounds = 10000;
+static constexpr u32 kLiveArrays = 8;
+
+static u32 destroyed = 0;
+
+struct Tracked {
+    u64 value;
+    ~Tracked() { destroyed++; }
+};
+
+struct Root {
+    ocxxr::RelPtr<double> arrays[kLiveArrays];
+    u32 sizes[kLiveArrays];
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Root> {
+    template <typename V>
+    static void Visit(Root &root, V &visitor) {
+        for (u32 i = 0; i < kLiveArrays; i++) {
+            visitor(root.arrays[i], root.sizes[i]);
+        }
+    }
+};
+
+}  // namespace ocxxr
+
+// Repeatedly replace arrays of varying sizes
+void Churn(ocxxr::Arena<Root> arena, u32 rounds) {
+    Root &root = arena.data();
+    for (u32 i = 0; i < rounds; i++) {
+        const u32 slot = i % kLiveArrays;
+        ocxxr::DeleteArray<double>(root.arrays[slot], root.sizes[slot]);
+        const u32 size = 1 + (i * 37) % 100;
+        double *array = ocxxr::NewArray<double>(size);
+        for (u32 j = 0; j < size; j++) {
+            array[j] = i;
+        }
+        root.arrays[slot] = array;
+        root.sizes[slot] = size;
+    }
+}
+
+void CheckArrays(ocxxr::Arena<Root> arena, u32 rounds) {
+    Root &root = arena.data();
+    for (u32 i = rounds - kLiveArrays; i < rounds; i++) {
+        const u32 slot = i % kLiveArrays;
+        ASSERT(root.sizes[slot] == 1 + (i * 37) % 100);
+        for (u32 j = 0; j < root.sizes[slot]; j++) {
+            ASSERT(root.arrays[slot][j] == i);
+        }
+    }
+}
+
+void ChildTask(ocxxr::Arena<Root> arena) {
+    PRINTF("Child task churning a relocated arena\n");
+    ocxxr::SetImplicitArena(arena);
+    Churn(arena, kRounds);
+    CheckArrays(arena, kRounds);
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<Root>::Create(kArenaBytes,
+                                            ocxxr::ArenaMode::kFreeList);
+    ocxxr::SetImplicitArena(arena);
+    Root *root = ocxxr::New<Root>();
+    ASSERT(root == arena.data_ptr());
+
+    // A deleted object's memory is reused for the next one of that size
+    Tracked *first = ocxxr::New<Tracked>();
+    ocxxr::Delete(first);
+    ASSERT(destroyed == 1);
+    ASSERT(arena.free_bytes() > 0);
+    Tracked *second = ocxxr::New<Tracked>();
+    ASSERT(second == first);
+    ASSERT(arena.free_bytes() == 0);
+    arena.Delete(second);
+    ASSERT(destroyed == 2);
+
+    // Similar sizes round up to the same size class
+    char *big = arena.NewArray<char>(6000);
+    arena.DeleteArray(big, 6000);
+    char *smaller = arena.NewArray<char>(5500);
+    ASSERT(smaller == big);
+    arena.DeleteArray(smaller, 5500);
+
+    // Far more than the arena could hold without reuse
+    for (u32 i = 0; i < kLiveArrays; i++) {
+        root->arrays[i] = nullptr;
+        root->sizes[i] = 0;
+    }
+    Churn(arena, kRounds);
+    CheckArrays(arena, kRounds);
+    PRINTF("Free-list bytes after churn: %" PRId64 "\n", arena.free_bytes());
+
+    // Deleting in a bump-allocated arena only runs the destructor
+    auto fixed = ocxxr::Arena<void>::Create(1024);
+    Tracked *leaked = fixed.New<Tracked>();
+    fixed.Delete(leaked);
+    ASSERT(destroyed == 3);
+    ASSERT(fixed.free_bytes() == 0);
+    Tracked *not_reused = fixed.New<Tracked>();
+    ASSERT(not_reused != leaked);
+    fixed.Destroy();
+
+    // Compacting keeps the free lists, so the compacted arena reuses memory
+    {
+        auto compact = arena.Compact();
+        PRINTF("Compacted arena from %" PRId64 " to %" PRId64 " bytes\n",
+               arena.size(), compact.size());
+        CheckArrays(compact, kRounds);
+        Root &copied = compact.data();
+        double *array = copied.arrays[0];
+        compact.DeleteArray(array, copied.sizes[0]);
+        ASSERT(compact.free_bytes() > 0);
+        double *reused = compact.NewArray<double>(copied.sizes[0]);
+        ASSERT(reused == array);
+        compact.Destroy();
+    }
+
+    // The free lists use offsets, so they survive copying the arena
+    auto copy = ocxxr::Arena<Root>::Create(kArenaBytes,
+                                           ocxxr::ArenaMode::kFreeList);
+    std::memcpy(copy.base_ptr(), arena.base_ptr(), arena.size());
+    ASSERT(copy.free_bytes() == arena.free_bytes());
+    Tracked *in_original = arena.New<Tracked>();
+    Tracked *in_copy = copy.New<Tracked>();
+    ASSERT(reinterpret_cast<char *>(in_copy) -
+                   static_cast<char *>(copy.base_ptr()) ==
+           reinterpret_cast<char *>(in_original) -
+                   static_cast<char *>(arena.base_ptr()));
+    arena.Destroy();
+    CheckArrays(copy, kRounds);
+    copy.Release();
+
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(copy);
+}
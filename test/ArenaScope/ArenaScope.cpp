@@ -0,0 +1,76 @@
+#include <ocxxr-main.hpp>
+
+static constexpr u64 kArenaBytes = 4096;
+// Far more than the arena can hold, unless each iteration's space is reused
+static constexpr u32 kIterations = 1000;
+static constexpr u32 kScratchCount = 100;
+
+template <typename T>
+bool InArena(ocxxr::Arena<void> arena, T *ptr) {
+    char *start = static_cast<char *>(arena.base_ptr());
+    char *p = reinterpret_cast<char *>(ptr);
+    return start <= p && p < start + arena.size();
+}
+
+// Library code that allocates in its own arena
+u32 *LibraryCount(ocxxr::Arena<void> scratch) {
+    ocxxr::ArenaScope scope(scratch);
+    u32 *count = ocxxr::New<u32>(42);
+    ASSERT(InArena(scratch, count));
+    return count;
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<void>::Create(kArenaBytes);
+    auto other = ocxxr::Arena<void>::Create(kArenaBytes);
+    ocxxr::SetImplicitArena(arena);
+    u32 *before = ocxxr::New<u32>(1);
+
+    // Temporary allocations are rolled back after each iteration
+    double *first_scratch = nullptr;
+    for (u32 i = 0; i < kIterations; i++) {
+        ocxxr::ArenaScope scratch;
+        double *values = ocxxr::NewArray<double>(kScratchCount);
+        if (i == 0) first_scratch = values;
+        ASSERT(values == first_scratch);
+        for (u32 j = 0; j < kScratchCount; j++) {
+            values[j] = i;
+        }
+    }
+
+    // Nested checkpoints
+    {
+        ocxxr::ArenaScope outer;
+        u32 *a = ocxxr::New<u32>(2);
+        {
+            ocxxr::ArenaScope inner;
+            ocxxr::NewArray<u32>(10);
+        }
+        u32 *b = ocxxr::New<u32>(3);
+        ASSERT(b == a + 1);
+    }
+    u32 *c = ocxxr::New<u32>(4);
+    ASSERT(c == before + 1);
+
+    // Pushing another arena doesn't clobber the caller's implicit arena
+    u32 *count = LibraryCount(other);
+    ASSERT(*count == 42 && InArena(other, count));
+    u32 *after = ocxxr::New<u32>(5);
+    ASSERT(InArena(arena, after));
+
+    // Changes to the implicit arena within a scope are undone
+    {
+        ocxxr::ArenaScope scope(arena);
+        ocxxr::SetImplicitArena(other);
+        u32 *in_other = ocxxr::New<u32>(6);
+        ASSERT(InArena(other, in_other));
+    }
+    u32 *restored = ocxxr::New<u32>(7);
+    ASSERT(InArena(arena, restored));
+
+    ASSERT(*before == 1);
+    PRINTF("Scoped arenas OK\n");
+    arena.Destroy();
+    other.Destroy();
+    ocxxr::Shutdown();
+}
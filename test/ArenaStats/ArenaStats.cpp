@@ -0,0 +1,90 @@
+#define OCXXR_ARENA_STATS
+#include <ocxxr-main.hpp>
+
+static constexpr u64 kArenaBytes = 4096;
+static constexpr s64 kHeaderBytes =
+        sizeof(ocxxr::internal::dballoc::DbArenaHeader);
+
+struct Root {
+    u64 id;
+    char tag;
+};
+
+void ChildTask(ocxxr::Arena<Root> arena) {
+    // the statistics travel with the arena
+    ocxxr::SetImplicitArena(arena);
+    ocxxr::NewArray<u32>(4);
+    const ocxxr::ArenaStats stats = arena.stats();
+    ASSERT(stats.allocations == 5);
+    ASSERT(stats.requested_bytes == 16 + 1 + 24 + 1000 + 16);
+    ASSERT(stats.high_water == kHeaderBytes + 1048);
+    arena.PrintStats("at end of child task");
+    arena.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<Root>::Create(kArenaBytes);
+    ocxxr::SetImplicitArena(arena);
+    ASSERT(arena.stats().allocations == 0);
+    ASSERT(arena.stats().high_water == kHeaderBytes);
+    ocxxr::New<Root>();
+    ocxxr::New<char>('x');
+    ocxxr::NewArray<double>(3);  // padded from offset 17 to 24
+    ocxxr::ArenaStats stats = arena.stats();
+    ASSERT(stats.allocations == 3);
+    ASSERT(stats.requested_bytes == 16 + 1 + 24);
+    ASSERT(stats.padding_bytes == 7);
+    ASSERT(stats.high_water == kHeaderBytes + 48);
+
+    // rolling back keeps the high-water mark
+    {
+        ocxxr::ArenaScope scratch;
+        ocxxr::NewArray<char>(1000);
+    }
+    ASSERT(arena.stats().high_water == kHeaderBytes + 1048);
+    ASSERT(arena.stats().allocations == 4);
+
+    // free lists count rounding up to a size class as padding
+    {
+        auto free_list = ocxxr::Arena<void>::Create(
+                kArenaBytes, ocxxr::ArenaMode::kFreeList);
+        ocxxr::ArenaScope scope(free_list);
+        u64 *a = ocxxr::New<u64>();
+        ocxxr::Delete(a);
+        u64 *b = ocxxr::New<u64>();
+        ASSERT(b == a);
+        stats = free_list.stats();
+        ASSERT(stats.allocations == 2 && stats.requested_bytes == 16);
+        ASSERT(stats.padding_bytes == 16);
+        ASSERT(stats.high_water == kHeaderBytes + 16);
+        free_list.Destroy();
+    }
+
+    // the high-water marks of chained datablocks add up
+    {
+        auto chained = ocxxr::Arena<void>::Create(256,
+                                                  ocxxr::ArenaMode::kChained);
+        ocxxr::ArenaScope scope(chained);
+        ocxxr::NewArray<char>(200);
+        ocxxr::NewArray<char>(200);
+        ASSERT(chained.chain_length() == 1);
+        ASSERT(chained.stats().high_water == 2 * (kHeaderBytes + 200));
+        chained.PrintStats("chained");
+        chained.Destroy();
+    }
+
+    // compacting starts a new count, at the compacted size
+    {
+        auto compact = arena.Compact();
+        ASSERT(compact.stats().allocations == 0);
+        ASSERT(compact.stats().high_water == compact.size());
+        compact.Destroy();
+    }
+
+    ASSERT(ocxxr::internal::dballoc::TypeName<Root>() == "Root");
+    arena.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(arena);
+}
@@ -0,0 +1,97 @@
+#include <ocxxr-main.hpp>
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+static constexpr u64 kArenaBytes = 64 * 1024;
+static constexpr u32 kCount = 1000;
+
+template <typename T>
+using ArenaVector = std::vector<T, ocxxr::ArenaAllocator<T>>;
+
+typedef std::basic_string<char, std::char_traits<char>,
+                          ocxxr::ArenaAllocator<char>>
+        ArenaString;
+
+struct Root {
+    ArenaVector<u32> values;
+    ArenaString name;
+    ArenaString tiny;  // (fits in the string object itself)
+    ArenaVector<ArenaString> words;
+};
+
+template <typename T>
+bool InArena(ocxxr::Arena<Root> arena, const T *ptr) {
+    const char *start = static_cast<const char *>(arena.base_ptr());
+    const char *p = reinterpret_cast<const char *>(ptr);
+    return start <= p && p < start + arena.size();
+}
+
+void CheckRoot(ocxxr::Arena<Root> arena, u32 count) {
+    Root &root = arena.data();
+    ASSERT(root.values.size() == count);
+    for (u32 i = 0; i < count; i++) {
+        ASSERT(root.values[i] == i * i);
+    }
+    ASSERT(InArena(arena, root.values.data()));
+    ASSERT(root.name == "a string long enough to need its own buffer");
+    ASSERT(InArena(arena, root.name.data()));
+    ASSERT(root.tiny == "tiny");
+    ASSERT(root.words.size() == 3 && root.words[2] == "three");
+}
+
+void ChildTask(ocxxr::Arena<Root> arena) {
+    PRINTF("Child task got the containers\n");
+    CheckRoot(arena, kCount);
+    // keep using the containers in the new task
+    ocxxr::SetImplicitArena(arena);
+    arena->values.push_back(kCount * kCount);
+    CheckRoot(arena, kCount + 1);
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<Root>::Create(kArenaBytes,
+                                            ocxxr::ArenaMode::kFreeList);
+    ocxxr::SetImplicitArena(arena);
+    Root *root = ocxxr::New<Root>();
+    ASSERT(root == arena.data_ptr());
+    for (u32 i = 0; i < kCount; i++) {
+        root->values.push_back(i * i);
+    }
+    root->name = "a string long enough to need its own buffer";
+    root->tiny = "tiny";
+    root->words.emplace_back("one");
+    root->words.emplace_back("two");
+    root->words.emplace_back("three");
+    CheckRoot(arena, kCount);
+    PRINTF("Free-list bytes after growing the vector: %" PRId64 "\n",
+           arena.free_bytes());
+
+    // Node containers can allocate in the arena (but can't be relocated)
+    {
+        std::map<u32, u32, std::less<u32>,
+                 ocxxr::ArenaAllocator<std::pair<const u32, u32>>>
+                squares;
+        for (u32 i = 0; i < 10; i++) {
+            squares[i] = i * i;
+        }
+        ASSERT(squares[7] == 49);
+        ASSERT(InArena(arena, &squares[7]));
+    }
+
+    // The containers move along with the datablock
+    auto copy = ocxxr::Arena<Root>::Create(kArenaBytes,
+                                           ocxxr::ArenaMode::kFreeList);
+    std::memcpy(copy.base_ptr(), arena.base_ptr(), arena.size());
+    std::memset(arena.base_ptr(), 0, arena.size());
+    arena.Destroy();
+    CheckRoot(copy, kCount);
+    copy.Release();
+
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(copy);
+}
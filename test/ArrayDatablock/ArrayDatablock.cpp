@@ -0,0 +1,100 @@
+#include <ocxxr-main.hpp>
+
+static constexpr u64 kCount = 1001;
+static constexpr u32 kParts = 4;
+
+struct alignas(32) Wide {
+    u64 values[4];
+};
+
+// Each part task doubles the elements in its own range
+void PartTask(ocxxr::ArrayRange range, ocxxr::ArrayDatablock<u64> array,
+              ocxxr::Datablock<u32> done) {
+    ASSERT(array.size() == kCount);
+    ocxxr::ArraySlice<u64> slice = array.Slice(range);
+    ASSERT(slice.size() == range.size());
+    u64 i = range.begin;
+    for (u64 &value : slice) {
+        ASSERT(value == i);
+        value *= 2;
+        i++;
+    }
+    ASSERT(i == range.end);
+    // the last part to finish checks the whole array
+    if (__atomic_add_fetch(done.data_ptr(), 1, __ATOMIC_ACQ_REL) == kParts) {
+        PRINTF("All parts finished\n");
+        for (u64 j = 0; j < array.size(); j++) {
+            ASSERT(array[j] == 2 * j);
+        }
+        array.Destroy();
+        done.Destroy();
+        PRINTF("Shutting down...\n");
+        ocxxr::Shutdown();
+    }
+}
+
+void CheckPartition() {
+    auto array = ocxxr::ArrayDatablock<u32>::Create(10);
+    for (u32 i = 0; i < array.size(); i++) {
+        array[i] = i;
+    }
+    // parts differ in size by at most one, and cover the array in order
+    auto parts = array.Partition(3);
+    ASSERT(parts.size() == 3);
+    u64 next = 0;
+    for (u64 p = 0; p < parts.size(); p++) {
+        ocxxr::ArraySlice<u32> part = parts[p];
+        ASSERT(part.size() == 3 || part.size() == 4);
+        ASSERT(part.range().begin == next);
+        ASSERT(part[0] == next);
+        ASSERT(part.data() == &array[next]);
+        next = part.range().end;
+    }
+    ASSERT(next == array.size());
+    // slices of slices keep their position in the whole array
+    ocxxr::ArraySlice<u32> middle = array.Slice(2, 8);
+    ocxxr::ArraySlice<u32> inner = middle.Slice(1, 4);
+    ASSERT(inner.range().begin == 3 && inner.range().end == 6);
+    ASSERT(inner[0] == 3 && inner.end()[-1] == 5);
+    auto halves = middle.Partition(2);
+    ASSERT(halves[1].range().begin == 5 && halves[1][0] == 5);
+    // more parts than elements gives some empty parts
+    auto tiny = array.Slice(0, 2).Partition(4);
+    u64 total = 0;
+    for (u64 p = 0; p < tiny.size(); p++) {
+        total += tiny[p].size();
+    }
+    ASSERT(total == 2 && array.Slice(4, 4).empty());
+    array.Destroy();
+
+    auto empty = ocxxr::ArrayDatablock<u32>::Create(0);
+    ASSERT(empty.empty() && empty.begin() == empty.end());
+    empty.Destroy();
+
+    // the elements follow a header padded to the element's alignment
+    static_assert(sizeof(ocxxr::ArrayState<Wide>) == alignof(Wide),
+                  "Header must be padded to the element alignment.");
+    static_assert(sizeof(ocxxr::ArrayState<u8>) == sizeof(u64),
+                  "Header must hold the element count.");
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    CheckPartition();
+
+    auto array = ocxxr::ArrayDatablock<u64>::Create(kCount);
+    u64 i = 0;
+    for (u64 &value : array) {
+        value = i++;
+    }
+    auto done = ocxxr::Datablock<u32>::Create();
+    *done = 0;
+    // the partition is computed before the array is released, since it
+    // reads the element count from the datablock
+    auto parts = array.Partition(kParts);
+    array.Release();
+    done.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(PartTask);
+    for (u32 p = 0; p < parts.size(); p++) {
+        task_template().CreateTask(parts[p].range(), array, done);
+    }
+}
@@ -0,0 +1,42 @@
+#include <ocxxr-main.hpp>
+
+// More datablocks than the old fixed-size bookkeeping tables could hold
+static constexpr u32 kDbCount = 600;
+
+typedef ocxxr::BasedPtr<u32> Ptr;
+
+void ChildTask(ocxxr::Datablock<Ptr> ptrs, ocxxr::DatablockList<u32> dbs) {
+    PRINTF("Running child task with %zu datablocks\n", dbs.count());
+    ASSERT(dbs.count() == kDbCount);
+    for (u32 i = 0; i < kDbCount; i++) {
+        ASSERT(*ptrs.data_ptr()[i] == i);
+        ASSERT(&*ptrs.data_ptr()[i] == dbs[i].data_ptr());
+    }
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto ptrs = ocxxr::Datablock<Ptr>::Create(kDbCount);
+    ocxxr::DatablockList<u32> dbs(kDbCount);
+    for (u32 i = 0; i < kDbCount; i++) {
+        auto db = ocxxr::Datablock<u32>::Create();
+        *db = i;
+        ptrs.data_ptr()[i] = db.data_ptr();
+        dbs.Add(db);
+    }
+    // Everything should still resolve after dropping every other datablock
+    for (u32 i = 0; i < kDbCount; i += 2) {
+        dbs[i].Release();
+    }
+    for (u32 i = 1; i < kDbCount; i += 2) {
+        ASSERT(*ptrs.data_ptr()[i] == i);
+    }
+    for (u32 i = 1; i < kDbCount; i += 2) {
+        dbs[i].Release();
+    }
+    ptrs.Release();
+    PRINTF("Creating child task\n");
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(ptrs, dbs);
+}
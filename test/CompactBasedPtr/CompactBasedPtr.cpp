@@ -0,0 +1,118 @@
+#include <ocxxr-main.hpp>
+
+// Much less than the list needs, so the arena has to grow
+static constexpr u64 kInitialBytes = 256;
+static constexpr u32 kLength = 1000;
+static constexpr u32 kExtraValues = 16;
+static constexpr u32 kMode =
+        ocxxr::ArenaMode::kChained | ocxxr::ArenaMode::kGuidTable;
+
+static_assert(sizeof(ocxxr::CompactBasedPtr<int>) == 8,
+              "CompactBasedPtr should be 8 bytes");
+
+struct Node {
+    u32 value;
+    ocxxr::CompactBasedPtr<Node> next;
+};
+
+struct List {
+    u32 length;
+    ocxxr::CompactBasedPtr<Node> head;
+    // points into a separate datablock
+    ocxxr::CompactBasedPtr<u64> extra;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Node> {
+    template <typename V>
+    static void Visit(Node &node, V &visitor) {
+        visitor(node.next);
+    }
+};
+
+template <>
+struct PointerFields<List> {
+    template <typename V>
+    static void Visit(List &list, V &visitor) {
+        visitor(list.head);
+        visitor(list.extra);
+    }
+};
+
+}  // namespace ocxxr
+
+void CheckList(ocxxr::Arena<List> arena) {
+    u32 expected = arena->length;
+    for (Node *node = arena->head; node; node = node->next) {
+        expected--;
+        ASSERT(node->value == expected);
+    }
+    ASSERT(expected == 0);
+    for (u32 i = 0; i < kExtraValues; i++) {
+        ASSERT(arena->extra[i] == i * i);
+    }
+    // arithmetic stays within the pointed-to datablock
+    ocxxr::CompactBasedPtr<u64> last = arena->extra + (kExtraValues - 1);
+    ASSERT(*last == (kExtraValues - 1) * (kExtraValues - 1));
+    ASSERT(last - arena->extra == kExtraValues - 1);
+    --last;
+    ASSERT(*last == (kExtraValues - 2) * (kExtraValues - 2));
+}
+
+void ChildTask(ocxxr::Arena<List> arena, ocxxr::Datablock<u64> extra,
+               ocxxr::DatablockList<void> chain) {
+    PRINTF("Child task got a chain of %zu datablocks\n", chain.count());
+    ASSERT(chain.count() == arena.chain_length());
+    // pointers are resolved through the implicit arena's GUID table
+    ocxxr::SetImplicitArena(arena);
+    CheckList(arena);
+    // copies are position-independent
+    ocxxr::CompactBasedPtr<Node> copy = arena->head;
+    ASSERT(copy->value == kLength - 1);
+    arena.Destroy();
+    extra.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<List>::Create(kInitialBytes, kMode);
+    ocxxr::SetImplicitArena(arena);
+    List *list = ocxxr::New<List>();
+    list->length = 0;
+    list->head = nullptr;
+    for (u32 i = 0; i < kLength; i++) {
+        Node *node = ocxxr::New<Node>();
+        node->value = list->length++;
+        node->next = list->head;
+        list->head = node;
+    }
+    PRINTF("Arena grew to %" PRIu32 " chained datablocks\n",
+           arena.chain_length());
+    ASSERT(arena.chain_length() > 0);
+
+    auto extra = ocxxr::Datablock<u64>::Create(kExtraValues);
+    for (u32 i = 0; i < kExtraValues; i++) {
+        extra.data_ptr()[i] = i * i;
+    }
+    list->extra = extra.data_ptr();
+    CheckList(arena);
+
+    // Compaction merges the chain into one datablock, and re-encodes the
+    // pointers for the compacted arena's GUID table
+    {
+        auto compact = arena.Compact();
+        ASSERT(compact.chain_length() == 0);
+        ocxxr::ArenaScope scope(compact);
+        CheckList(compact);
+        compact.Destroy();
+    }
+
+    auto chain = arena.Chain();
+    extra.Release();
+    arena.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(arena, extra, chain);
+}
@@ -0,0 +1,62 @@
+#include <ocxxr-main.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+static constexpr u32 kDbCount = 8;
+
+typedef ocxxr::BasedPtr<u32> Ptr;
+
+void ChildTask(ocxxr::Datablock<Ptr> ptrs, ocxxr::DatablockList<u32> dbs) {
+    PRINTF("Running child task with %zu datablocks\n", dbs.count());
+    ASSERT(dbs.count() == kDbCount);
+    u32 i = 0;
+    for (auto db : dbs) {
+        ASSERT(*db == i);
+        ASSERT(&*ptrs.data_ptr()[i] == db.data_ptr());
+        i++;
+    }
+    // the view over the task's dependences is random-access
+    auto first = dbs.begin();
+    auto last = dbs.end();
+    ASSERT(last - first == kDbCount && std::distance(first, last) == kDbCount);
+    ASSERT(*first[3] == 3 && *(first + 5)[1] == 6 && **(2 + first) == 2);
+    --last;
+    ASSERT(**last == kDbCount - 1 && first < last && !(last < first));
+    // releasing a datablock from the list updates the bookkeeping
+    dbs[0].Release();
+    ASSERT(*ptrs.data_ptr()[1] == 1);
+    // (the view is read-only, so sort a copy)
+    std::vector<ocxxr::Datablock<u32>> sorted(dbs.begin() + 1, dbs.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](ocxxr::Datablock<u32> a, ocxxr::Datablock<u32> b) {
+                  return *a > *b;
+              });
+    for (u32 j = 1; j < kDbCount; j++) {
+        ASSERT(*sorted[j - 1] == kDbCount - j && *dbs[j] == j);
+    }
+    for (auto db : dbs) {
+        db.Destroy();
+    }
+    ptrs.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto ptrs = ocxxr::Datablock<Ptr>::Create(kDbCount);
+    ocxxr::DatablockList<u32, kDbCount> dbs;
+    ASSERT(dbs.capacity() == kDbCount && dbs.count() == 0);
+    for (u32 i = 0; i < kDbCount; i++) {
+        auto db = ocxxr::Datablock<u32>::Create();
+        *db = i;
+        ptrs.data_ptr()[i] = db.data_ptr();
+        db.Release();
+        dbs.Add(db);
+    }
+    ptrs.Release();
+    PRINTF("Creating child task\n");
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(ptrs, dbs);
+}
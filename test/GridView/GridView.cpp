@@ -0,0 +1,117 @@
+#include <ocxxr-main.hpp>
+
+#include <vector>
+
+static constexpr size_t kRows = 13;
+static constexpr size_t kCols = 21;
+
+typedef ocxxr::GridView<double, ocxxr::Dims<2>, ocxxr::Tiled<4, 8>> TiledGrid;
+
+// Every element of the grid maps to its own slot in the storage
+template <typename Grid>
+void CheckLayout(const typename Grid::extents_type &extents) {
+    std::vector<double> storage(Grid::RequiredSize(extents));
+    std::vector<bool> used(storage.size(), false);
+    Grid grid(storage.data(), extents);
+    ASSERT(grid.size() == kRows * kCols);
+    ASSERT(grid.required_size() >= grid.size());
+    for (size_t i = 0; i < grid.extent(0); i++) {
+        for (size_t j = 0; j < grid.extent(1); j++) {
+            const size_t offset = &grid(i, j) - grid.data();
+            ASSERT(offset < storage.size() && !used[offset]);
+            used[offset] = true;
+            grid(i, j) = i * 100 + j;
+        }
+    }
+    for (size_t i = 0; i < grid.extent(0); i++) {
+        for (size_t j = 0; j < grid.extent(1); j++) {
+            ASSERT(grid(i, j) == i * 100 + j);
+        }
+    }
+}
+
+void CheckLayouts() {
+    using namespace ocxxr;
+    const Dims<2> dims(kRows, kCols);
+    CheckLayout<GridView<double, Dims<2>, RowMajor>>(dims);
+    CheckLayout<GridView<double, Dims<2>, ColumnMajor>>(dims);
+    CheckLayout<GridView<double, Dims<2>, Tiled<4, 8>>>(dims);
+    CheckLayout<GridView<double, Dims<2>, Tiled<3, 5>>>(dims);
+    CheckLayout<GridView<double, Dims<2>, Morton>>(dims);
+    CheckLayout<GridView<double, Extents<kRows, kCols>, Morton>>(
+            Extents<kRows, kCols>());
+    CheckLayout<GridView<double, Extents<kDynamicExtent, kCols>, RowMajor>>(
+            Extents<kDynamicExtent, kCols>(kRows));
+
+    // known offsets
+    const Dims<2> square(4, 4);
+    RowMajor::Mapping<Dims<2>> row_major(square);
+    ColumnMajor::Mapping<Dims<2>> column_major(square);
+    Tiled<2, 2>::Mapping<Dims<2>> tiled(square);
+    Morton::Mapping<Dims<2>> morton(square);
+    ASSERT(row_major(1, 2) == 6 && column_major(1, 2) == 9);
+    ASSERT(tiled(1, 2) == 6 && tiled(2, 1) == 9 && tiled(3, 0) == 10);
+    ASSERT(morton(1, 2) == 6 && morton(2, 1) == 9 && morton(3, 3) == 15);
+    // the tiles and Morton squares are padded out to whole tiles/squares
+    ASSERT(TiledGrid::RequiredSize(Dims<2>(5, 9)) == 8 * 16);
+    ASSERT(Morton::Mapping<Dims<2>>(Dims<2>(3, 5)).required_size() ==
+           morton(2, 4) + 1);
+
+    // higher ranks
+    const Dims<3> cube(2, 3, 4);
+    RowMajor::Mapping<Dims<3>> row_major3(cube);
+    ColumnMajor::Mapping<Dims<3>> column_major3(cube);
+    ASSERT(row_major3(1, 2, 3) == 23 && column_major3(1, 2, 3) == 23);
+    ASSERT(row_major3(1, 0, 0) == 12 && column_major3(1, 0, 0) == 1);
+    double values[24];
+    GridView<double, Dims<3>, ColumnMajor> grid3(values, cube);
+    grid3(1, 2, 3) = 1.5;
+    ASSERT(values[23] == 1.5 && grid3.size() == 24);
+
+    // static extents are known at compile time, but still stored
+    static_assert(sizeof(Extents<kRows, kCols>) == 2 * sizeof(size_t),
+                  "Extents store one size per dimension.");
+    static_assert(Extents<kDynamicExtent, 4>::kDynamicRank == 1,
+                  "Only dynamic extents are passed to the constructor.");
+}
+
+// The grid's storage is a plain array, so it can be relocated freely
+void CheckTask(ocxxr::ArrayDatablock<double> storage) {
+    TiledGrid grid(storage.data(), ocxxr::Dims<2>(kRows, kCols));
+    ASSERT(storage.size() == grid.required_size());
+    for (size_t i = 0; i < kRows; i++) {
+        for (size_t j = 0; j < kCols; j++) {
+            ASSERT(grid(i, j) == i * 100 + j);
+        }
+    }
+    storage.Destroy();
+    PRINTF("Grid checked\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    CheckLayouts();
+
+    // a grid allocated in an arena
+    auto arena = ocxxr::Arena<void>::Create(1 << 16);
+    ocxxr::SetImplicitArena(arena);
+    auto in_arena = ocxxr::GridView<u32, ocxxr::Dims<2>, ocxxr::Morton>::New(
+            ocxxr::Dims<2>(8, 8));
+    in_arena(7, 7) = 42;
+    ASSERT(in_arena.data()[63] == 42);
+    arena.Destroy();
+
+    // a grid in its own datablock, passed to another task
+    const ocxxr::Dims<2> dims(kRows, kCols);
+    const size_t storage_size = TiledGrid::RequiredSize(dims);
+    auto storage = ocxxr::ArrayDatablock<double>::Create(storage_size);
+    TiledGrid grid(storage.data(), dims);
+    for (size_t i = 0; i < kRows; i++) {
+        for (size_t j = 0; j < kCols; j++) {
+            grid(i, j) = i * 100 + j;
+        }
+    }
+    storage.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(CheckTask);
+    task_template().CreateTask(storage);
+}
@@ -0,0 +1,120 @@
+#include <ocxxr-main.hpp>
+
+#include <cstring>
+
+static constexpr u64 kArenaBytes = 64 * 1024;
+static constexpr u32 kRows = 10;
+static constexpr u32 kCols = 20;
+
+// Like the Grid2D test, but with growable rows
+struct Grid {
+    ocxxr::RelString name;
+    ocxxr::RelVector<ocxxr::RelVector<double>> rows;
+    ocxxr::RelSpan<double> diagonal_row;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Grid> {
+    template <typename V>
+    static void Visit(Grid &grid, V &visitor) {
+        PointerFields<RelString>::Visit(grid.name, visitor);
+        PointerFields<RelVector<RelVector<double>>>::Visit(grid.rows, visitor);
+        // (diagonal_row views part of a row, so it can't be compacted)
+    }
+};
+
+}  // namespace ocxxr
+
+void CheckGrid(ocxxr::Arena<Grid> arena) {
+    Grid &grid = arena.data();
+    ASSERT(grid.name == "grid of doubles");
+    ASSERT(grid.rows.size() == kRows);
+    for (u32 r = 0; r < kRows; r++) {
+        ocxxr::RelSpan<double> row = grid.rows[r].span();
+        ASSERT(row.size() == kCols);
+        double sum = 0;
+        for (double value : row) {
+            sum += value;
+        }
+        ASSERT(sum == kCols * r + kCols * (kCols - 1) / 2.0);
+    }
+}
+
+void ChildTask(ocxxr::Arena<Grid> arena) {
+    PRINTF("Child task got the grid\n");
+    CheckGrid(arena);
+    Grid &grid = arena.data();
+    ASSERT(grid.diagonal_row.size() == 2 && grid.diagonal_row[0] == 4.0);
+    // keep growing the containers in the new task
+    ocxxr::SetImplicitArena(arena);
+    grid.rows.emplace_back(kCols);
+    grid.name += " (extended)";
+    ASSERT(grid.rows.size() == kRows + 1);
+    ASSERT(grid.name == "grid of doubles (extended)");
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<Grid>::Create(kArenaBytes,
+                                            ocxxr::ArenaMode::kFreeList);
+    ocxxr::SetImplicitArena(arena);
+    Grid *grid = ocxxr::New<Grid>();
+    grid->name = "grid";
+    grid->name.append(" of doubles");
+    for (u32 r = 0; r < kRows; r++) {
+        grid->rows.emplace_back();
+        for (u32 c = 0; c < kCols; c++) {
+            grid->rows.back().push_back(r + c);
+        }
+    }
+    grid->diagonal_row = grid->rows[2].span().subspan(2, 2);
+    CheckGrid(arena);
+
+    {
+        ocxxr::RelVector<u32> small = {1, 2, 3};
+        ASSERT(small.size() == 3 && small[2] == 3);
+        small.resize(1);
+        ASSERT(small.size() == 1 && small.capacity() >= 3);
+    }
+
+    // Storage is only freed into the arena it came from
+    {
+        typedef ocxxr::RelVector<double> Row;
+        Row *row = ocxxr::New<Row>(kCols);
+        auto other = ocxxr::Arena<void>::Create(1024,
+                                                ocxxr::ArenaMode::kFreeList);
+        const s64 free_bytes = arena.free_bytes();
+        {
+            ocxxr::ArenaScope scope(other);
+            row->~Row();
+        }
+        ASSERT(other.free_bytes() == 0 && arena.free_bytes() == free_bytes);
+        other.Destroy();
+    }
+
+    // Compaction keeps the (spare) capacity of each vector
+    {
+        grid->diagonal_row = ocxxr::RelSpan<double>();
+        auto compact = arena.Compact();
+        PRINTF("Compacted grid from %" PRId64 " to %" PRId64 " bytes\n",
+               arena.size(), compact.size());
+        CheckGrid(compact);
+        compact.Destroy();
+        grid->diagonal_row = grid->rows[2].span().subspan(2, 2);
+    }
+
+    // The containers move along with the datablock
+    auto copy = ocxxr::Arena<Grid>::Create(kArenaBytes,
+                                           ocxxr::ArenaMode::kFreeList);
+    std::memcpy(copy.base_ptr(), arena.base_ptr(), arena.size());
+    std::memset(arena.base_ptr(), 0, arena.size());
+    arena.Destroy();
+    CheckGrid(copy);
+    copy.Release();
+
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(copy);
+}
@@ -0,0 +1,214 @@
+#include <ocxxr-main.hpp>
+
+#include <cstring>
+#include <unordered_map>
+
+static constexpr u64 kArenaBytes = 1 << 20;
+static constexpr u32 kKeys = 2000;
+static constexpr u32 kRecords = 8;
+
+typedef ocxxr::RelHashMap<u32, u64> Map;
+
+struct Index {
+    Map counts;
+    ocxxr::RelHashMap<u64, ocxxr::RelString> names;
+};
+
+struct Record {
+    u64 first;
+    u32 second;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Index> {
+    template <typename V>
+    static void Visit(Index &index, V &visitor) {
+        PointerFields<Map>::Visit(index.counts, visitor);
+        // (the names map isn't compacted, since its values have pointers)
+    }
+};
+
+}  // namespace ocxxr
+
+void CheckCounts(const Map &counts) {
+    ASSERT(counts.size() == kKeys);
+    u64 sum = 0;
+    for (const auto &entry : counts) {
+        ASSERT(entry.second == entry.first * 3);
+        sum += entry.first;
+    }
+    ASSERT(sum == u64{kKeys} * (kKeys - 1) / 2);
+    for (u32 key = 0; key < kKeys; key++) {
+        auto found = counts.find(key);
+        ASSERT(found != counts.end() && found->second == key * 3);
+    }
+    ASSERT(!counts.contains(kKeys));
+}
+
+void ChildTask(ocxxr::Arena<Index> arena,
+               ocxxr::DatablockList<Record> records) {
+    PRINTF("Child task got the index\n");
+    Index &index = arena.data();
+    CheckCounts(index.counts);
+    ASSERT(index.names.size() == 1 && index.names.find(7)->second == "seven");
+    // bulk-build a map from the records passed to the task
+    ocxxr::SetImplicitArena(arena);
+    ocxxr::RelHashMap<u64, u32> by_id;
+    by_id.InsertAll(records);
+    ASSERT(by_id.size() == kRecords);
+    for (u32 i = 0; i < kRecords; i++) {
+        ASSERT(by_id.find(u64{i} << 40)->second == i);
+    }
+    for (auto db : records) {
+        db.Destroy();
+    }
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+// Compare against std::unordered_map under a mix of operations
+void CheckRandomOps() {
+    Map map;
+    std::unordered_map<u32, u64> expected;
+    u32 state = 12345;
+    for (u32 i = 0; i < 50000; i++) {
+        state = state * 1103515245u + 12345u;
+        const u32 key = (state >> 8) % 512;
+        switch ((state >> 4) % 3) {
+            case 0:
+                map[key] = i;
+                expected[key] = i;
+                break;
+            case 1: {
+                const size_t erased = map.erase(key);
+                const size_t expected_erased = expected.erase(key);
+                ASSERT(erased == expected_erased);
+                break;
+            }
+            default:
+                ASSERT(map.contains(key) == (expected.count(key) == 1));
+                break;
+        }
+    }
+    ASSERT(map.size() == expected.size());
+    for (const auto &entry : expected) {
+        ASSERT(map.find(entry.first)->second == entry.second);
+    }
+    // lots of erasures fill the table with tombstones, but don't grow it
+    ASSERT(map.capacity() <= 1024);
+}
+
+// Clearing a table with tombstones and refilling it past its old load
+void CheckClear() {
+    Map map;
+    map.reserve(896);
+    const size_t capacity = map.capacity();
+    for (u32 key = 0; key < 896; key++) {
+        map[key] = key;
+    }
+    for (u32 key = 0; key < 800; key += 2) {
+        const size_t erased = map.erase(key);
+        ASSERT(erased == 1);
+    }
+    map.clear();
+    ASSERT(map.empty() && !map.contains(1));
+    const u32 refill = static_cast<u32>(capacity - capacity / 16);
+    for (u32 key = 0; key < refill; key++) {
+        map[key + 10000] = key;
+    }
+    ASSERT(map.size() == refill && map.capacity() > capacity);
+    ASSERT(!map.contains(5) && map.find(10000 + refill - 1)->second ==
+                                       refill - 1);
+}
+
+// Destroying a map while another arena is implicit leaves its arrays
+void CheckOtherArena(ocxxr::Arena<Index> arena) {
+    Map *map = ocxxr::New<Map>();
+    (*map)[1] = 2;
+    auto other = ocxxr::Arena<void>::Create(1024, ocxxr::ArenaMode::kFreeList);
+    const s64 free_bytes = arena.free_bytes();
+    {
+        ocxxr::ArenaScope scope(other);
+        map->~Map();
+    }
+    ASSERT(other.free_bytes() == 0 && arena.free_bytes() == free_bytes);
+    other.Destroy();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto arena = ocxxr::Arena<Index>::Create(kArenaBytes,
+                                             ocxxr::ArenaMode::kFreeList);
+    ocxxr::SetImplicitArena(arena);
+    Index *index = ocxxr::New<Index>();
+
+    // grows from empty
+    for (u32 key = 0; key < kKeys; key++) {
+        auto inserted = index->counts.emplace(key, key);
+        ASSERT(inserted.second && inserted.first->first == key);
+    }
+    for (u32 key = 0; key < kKeys; key++) {
+        auto existing = index->counts.emplace(key, 0);
+        ASSERT(!existing.second && existing.first->second == key);
+        index->counts[key] *= 3;
+    }
+    CheckCounts(index->counts);
+    ASSERT(index->counts.capacity() == 4096);
+
+    // erase and re-insert half of the keys
+    for (u32 key = 0; key < kKeys; key += 2) {
+        const size_t erased = index->counts.erase(key);
+        const size_t erased_again = index->counts.erase(key);
+        ASSERT(erased == 1 && erased_again == 0);
+    }
+    ASSERT(index->counts.size() == kKeys / 2);
+    const Record evens[] = {{0, 0}, {2, 6}, {4, 12}};
+    index->counts.InsertAll(evens, 3);
+    for (u32 key = 6; key < kKeys; key += 2) {
+        index->counts.insert({key, key * 3});
+    }
+    CheckCounts(index->counts);
+    ASSERT(index->counts.capacity() == 4096);
+
+    CheckOtherArena(arena);
+
+    index->names[7] = "seven";
+    ASSERT(index->names[7] == "seven");
+
+    {
+        ArenaScope scope;
+        CheckRandomOps();
+        CheckClear();
+    }
+
+    // Compaction copies both arrays of the map
+    {
+        auto compact = arena.Compact();
+        PRINTF("Compacted index from %" PRId64 " to %" PRId64 " bytes\n",
+               arena.size(), compact.size());
+        CheckCounts(compact.data().counts);
+        compact.Destroy();
+    }
+
+    // The map moves along with the datablock
+    auto copy = ocxxr::Arena<Index>::Create(kArenaBytes,
+                                            ocxxr::ArenaMode::kFreeList);
+    std::memcpy(copy.base_ptr(), arena.base_ptr(), arena.size());
+    std::memset(arena.base_ptr(), 0, arena.size());
+    arena.Destroy();
+    CheckCounts(copy.data().counts);
+    copy.Release();
+
+    ocxxr::DatablockList<Record, kRecords> records;
+    for (u32 i = 0; i < kRecords; i++) {
+        auto db = ocxxr::Datablock<Record>::Create();
+        db->first = u64{i} << 40;
+        db->second = i;
+        db.Release();
+        records.Add(db);
+    }
+
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(copy, records);
+}
@@ -0,0 +1,102 @@
+#include <ocxxr-main.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+
+static constexpr u32 kCount = 64;
+
+template <typename P>
+void CheckTraits() {
+    typedef std::iterator_traits<P> Traits;
+    static_assert(std::is_same<typename Traits::iterator_category,
+                               std::random_access_iterator_tag>::value,
+                  "should be a random-access iterator");
+    static_assert(std::is_same<typename Traits::value_type, u32>::value,
+                  "value type should drop const");
+    static_assert(std::is_same<typename Traits::difference_type,
+                               ptrdiff_t>::value,
+                  "difference type should be ptrdiff_t");
+}
+
+// A range of relative pointers, stored in the same datablock as its data
+struct Range {
+    ocxxr::RelPtr<u32> begin;
+    ocxxr::RelPtr<u32> end;
+};
+
+template <template <typename...> class P>
+void CheckArithmetic(u32 *values) {
+    P<u32> p = values;
+    ASSERT(*(p + 3) == values[3]);
+    ASSERT(*(3 + p) == values[3]);
+    ASSERT(p[kCount - 1] == values[kCount - 1]);
+    ASSERT(p[size_t{2}] == values[2]);
+    P<u32> q = p;
+    ++q;
+    ASSERT(*q == values[1]);
+    const u32 *old = q++;
+    ASSERT(*old == values[1]);
+    ASSERT(q == values + 2);
+    q += 10;
+    ASSERT(q - p == 12);
+    --q;
+    ASSERT(*q == values[11]);
+    old = q--;
+    ASSERT(*old == values[11]);
+    q -= 10;
+    ASSERT(q == p && !(q < p) && q <= p);
+    ASSERT(p < p + 1 && p + 1 > p && p + 1 != p);
+    ASSERT(*(p + 5 - 2) == values[3]);
+    // standard algorithms accept the pointers as iterators
+    ASSERT(std::distance(p, p + kCount) == kCount);
+    P<u32> found = std::find(p, p + kCount, values[40]);
+    ASSERT(found == values + 40);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    CheckTraits<ocxxr::RelPtr<u32>>();
+    CheckTraits<ocxxr::RelPtr<const u32>>();
+    CheckTraits<ocxxr::BasedPtr<u32>>();
+
+    auto arena = ocxxr::Arena<Range>::Create(4096);
+    ocxxr::SetImplicitArena(arena);
+    Range *range = ocxxr::New<Range>();
+    u32 *values = ocxxr::NewArray<u32>(kCount);
+    for (u32 i = 0; i < kCount; i++) {
+        values[i] = (i * 37) % kCount;
+    }
+
+    CheckArithmetic<ocxxr::RelPtr>(values);
+    CheckArithmetic<ocxxr::BasedPtr>(values);
+
+    // sort and sum through the relative pointers
+    range->begin = values;
+    range->end = values + kCount;
+    std::sort(range->begin, range->end);
+    for (u32 i = 0; i < kCount; i++) {
+        ASSERT(values[i] == i);
+    }
+    ASSERT(std::accumulate(range->begin, range->end, u32{0}) ==
+           kCount * (kCount - 1) / 2);
+
+    // moving the datablock keeps the range valid
+    const size_t used = reinterpret_cast<char *>(values + kCount) -
+                        reinterpret_cast<char *>(range);
+    char *copy = new char[used];
+    std::memcpy(copy, range, used);
+    Range *moved = reinterpret_cast<Range *>(copy);
+    ocxxr::RelPtr<u32> it = moved->begin;
+    it += kCount / 2;
+    ASSERT(*it == kCount / 2);
+    ASSERT(moved->end - moved->begin == kCount);
+    ASSERT(moved->begin != range->begin);
+    PRINTF("Sum after moving = %" PRIu32 "\n",
+           std::accumulate(moved->begin, moved->end, u32{0}));
+    delete[] copy;
+
+    arena.Destroy();
+    ocxxr::Shutdown();
+}
@@ -0,0 +1,141 @@
+#include <ocxxr-main.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+static constexpr u32 kNodes = 1000;
+static constexpr u64 kArenaBytes = 1 << 16;
+
+static_assert(sizeof(ocxxr::RelPtr<int>) == sizeof(ptrdiff_t),
+              "default RelPtr should be full width");
+static_assert(sizeof(ocxxr::RelPtr32<int>) == 4, "RelPtr32 should be 4 bytes");
+static_assert(sizeof(ocxxr::RelPtr16<int>) == 2, "RelPtr16 should be 2 bytes");
+static_assert(std::is_same<ocxxr::NestedRelPtr<int, 2, s16>,
+                           ocxxr::RelPtr16<ocxxr::RelPtr16<int>>>::value,
+              "NestedRelPtr should propagate the offset type");
+static_assert(std::is_same<ocxxr::RelPtrFor<int **, s32>,
+                           ocxxr::RelPtr32<ocxxr::RelPtr32<int>>>::value,
+              "RelPtrFor should propagate the offset type");
+static_assert(std::is_same<ocxxr::NestedRelPtr<int, 2>,
+                           ocxxr::RelPtr<ocxxr::RelPtr<int>>>::value,
+              "NestedRelPtr should default to full-width offsets");
+static_assert(std::is_same<ocxxr::RelPtr16<int>::Result, int *>::value,
+              "narrow RelPtr arithmetic should give raw pointers");
+static_assert(std::is_same<std::iterator_traits<ocxxr::RelPtr<int>>::
+                                   iterator_category,
+                           std::random_access_iterator_tag>::value,
+              "full-width RelPtr should be a random-access iterator");
+
+// A binary search tree, with half-size nodes thanks to 32-bit offsets
+struct Node {
+    u32 key;
+    ocxxr::RelPtr32<Node> left;
+    ocxxr::RelPtr32<Node> right;
+};
+
+static_assert(sizeof(Node) == 12, "Node should use 32-bit offsets");
+
+struct Tree {
+    ocxxr::RelPtr32<Node> root;
+    u32 size;
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Node> {
+    template <typename V>
+    static void Visit(Node &node, V &visitor) {
+        visitor(node.left);
+        visitor(node.right);
+    }
+};
+
+template <>
+struct PointerFields<Tree> {
+    template <typename V>
+    static void Visit(Tree &tree, V &visitor) {
+        visitor(tree.root);
+    }
+};
+
+}  // namespace ocxxr
+
+Node *Build(u32 lo, u32 hi) {
+    if (lo >= hi) return nullptr;
+    const u32 mid = lo + (hi - lo) / 2;
+    Node *node = ocxxr::New<Node>();
+    node->key = mid;
+    node->left = Build(lo, mid);
+    node->right = Build(mid + 1, hi);
+    return node;
+}
+
+u32 CheckTree(const Node *node, u32 lo, u32 hi) {
+    if (!node) return 0;
+    ASSERT(lo <= node->key && node->key < hi);
+    return 1 + CheckTree(node->left, lo, node->key) +
+           CheckTree(node->right, node->key + 1, hi);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    // nested narrow pointers
+    int x = 7;
+    ocxxr::RelPtr16<int> p1 = &x;
+    ocxxr::NestedRelPtr<int, 2, s16> p2 = &p1;
+    ocxxr::RelPtrFor<int ***, s16> p3 = &p2;
+    ASSERT(***p3 == 7);
+    ocxxr::RelPtr16<int> null = nullptr;
+    ASSERT(null == nullptr && !null);
+
+    auto arena = ocxxr::Arena<Tree>::Create(kArenaBytes);
+    ocxxr::SetImplicitArena(arena);
+    Tree *tree = ocxxr::New<Tree>();
+    tree->root = Build(0, kNodes);
+    tree->size = kNodes;
+    ASSERT(CheckTree(tree->root, 0, kNodes) == kNodes);
+    PRINTF("Tree of %" PRIu32 " nodes uses %zu bytes\n", kNodes,
+           kNodes * sizeof(Node));
+
+    // narrow pointers support arithmetic too
+    // (the pointer must be near its target, so it goes in the arena)
+    u16 *values = ocxxr::NewArray<u16>(16);
+    for (u16 i = 0; i < 16; i++) {
+        values[i] = i;
+    }
+    ocxxr::RelPtr16<u16> &it = *ocxxr::New<ocxxr::RelPtr16<u16>>();
+    it = values;
+    it += 15;
+    ASSERT(*it == 15);
+    --it;
+    ASSERT(*it == 14 && it - values == 14);
+    ASSERT(it[-14] == 0);
+    // (arithmetic that makes a new pointer gives a raw pointer)
+    u16 *ahead = it + 1;
+    ASSERT(*ahead == 15 && *(it - 2) == 12 && *(1 + it) == 15);
+    u16 *before = it--;
+    ASSERT(*before == 14 && *it == 13);
+    before = it++;
+    ASSERT(*before == 13 && *it == 14);
+    std::sort(it - 14, it + 2, [](u16 a, u16 b) { return a > b; });
+    ASSERT(values[0] == 15 && values[15] == 0 && *it == 1);
+
+    // a relocated copy of the arena is still valid
+    char *copy = new char[arena.size()];
+    char *base = static_cast<char *>(arena.base_ptr());
+    std::memcpy(copy, base, arena.size());
+    const ptrdiff_t root_offset = reinterpret_cast<char *>(tree) - base;
+    Tree *moved = reinterpret_cast<Tree *>(copy + root_offset);
+    ASSERT(CheckTree(moved->root, 0, kNodes) == kNodes);
+    delete[] copy;
+
+    // and compaction preserves narrow pointers
+    auto compact = arena.Compact();
+    ASSERT(CheckTree(compact->root, 0, kNodes) == kNodes);
+    compact.Destroy();
+
+    arena.Destroy();
+    ocxxr::Shutdown();
+}
@@ -0,0 +1,115 @@
+#include <ocxxr-main.hpp>
+
+#include <cstring>
+#include <vector>
+
+static constexpr u64 kArenaBytes = 64 * 1024;
+static constexpr u32 kCount = 1000;
+
+struct Particle {
+    float x;
+    float v;
+    u32 id;
+};
+
+// x, v, id
+typedef ocxxr::SoA<float, float, u32> Particles;
+
+void CheckParticles(const Particles &particles, float dt) {
+    ASSERT(particles.size() == kCount);
+    u32 i = 0;
+    for (Particles::const_reference p : particles) {
+        ASSERT(p.get<2>() == i);
+        ASSERT(p.get<1>() == i * 0.5f);
+        ASSERT(p.get<0>() == i + dt * (i * 0.5f));
+        i++;
+    }
+    ASSERT(i == kCount);
+}
+
+void CheckTask(ocxxr::Arena<Particles> arena) {
+    CheckParticles(arena.data(), 1.0f);
+    arena.Destroy();
+    PRINTF("Particles checked\n");
+    ocxxr::Shutdown();
+}
+
+void CheckProxies() {
+    auto arena = ocxxr::Arena<void>::Create(kArenaBytes);
+    ocxxr::SetImplicitArena(arena);
+    Particles &table = *ocxxr::New<Particles>(3);
+    // fields start value-initialized
+    ASSERT(table[2].get<0>() == 0.0f && table[2].get<2>() == 0);
+    table[0] = std::make_tuple(1.0f, 2.0f, u32{3});
+    table[1] = table[0];  // copies the values
+    table[1].get<2>() = 4;
+    ASSERT(table[0].get<2>() == 3 && table[1].get<2>() == 4);
+    const std::tuple<float, float, u32> record = table[1];
+    ASSERT(std::get<0>(record) == 1.0f && std::get<2>(record) == 4);
+    ASSERT(table.column<1>()[1] == 2.0f);
+    // each column starts on a cache line
+    ASSERT(reinterpret_cast<uintptr_t>(table.column<0>()) %
+                   Particles::kColumnAlignment ==
+           0);
+    ASSERT(reinterpret_cast<uintptr_t>(table.column<2>()) %
+                   Particles::kColumnAlignment ==
+           0);
+    // destroying the table while another arena is implicit leaves the
+    // columns alone
+    auto other = ocxxr::Arena<void>::Create(1024, ocxxr::ArenaMode::kFreeList);
+    {
+        ocxxr::ArenaScope scope(other);
+        table.~Particles();
+    }
+    ASSERT(other.free_bytes() == 0);
+    other.Destroy();
+    arena.Destroy();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    CheckProxies();
+
+    auto arena = ocxxr::Arena<Particles>::Create(kArenaBytes);
+    ocxxr::SetImplicitArena(arena);
+    Particles &particles = *ocxxr::New<Particles>(kCount);
+
+    // bulk conversion from an array of structs, and back
+    std::vector<Particle> records(kCount);
+    for (u32 i = 0; i < kCount; i++) {
+        records[i] = {static_cast<float>(i), i * 0.5f, i};
+    }
+    particles.CopyFromAoS(records.data(), kCount, &Particle::x, &Particle::v,
+                          &Particle::id);
+    // a kernel over just two of the columns
+    float *x = particles.column<0>();
+    const float *v = particles.column<1>();
+    for (u32 i = 0; i < kCount; i++) {
+        x[i] += 1.0f * v[i];
+    }
+    CheckParticles(particles, 1.0f);
+    std::vector<Particle> out(kCount);
+    particles.CopyToAoS(out.data(), kCount, &Particle::x, &Particle::v,
+                        &Particle::id);
+    for (u32 i = 0; i < kCount; i++) {
+        ASSERT(out[i].id == i && out[i].x == x[i]);
+    }
+
+    // the columns move with the datablock
+    auto copy = ocxxr::Arena<Particles>::Create(kArenaBytes);
+    memcpy(copy.base_ptr(), arena.base_ptr(), arena.size());
+    memset(x, 0, kCount * sizeof(float));
+    CheckParticles(copy.data(), 1.0f);
+    copy.Destroy();
+
+    // and are found by Arena#Compact
+    for (u32 i = 0; i < kCount; i++) {
+        x[i] = i + v[i];
+    }
+    auto compact = arena.Compact();
+    arena.Destroy();
+    CheckParticles(compact.data(), 1.0f);
+    compact.Release();
+
+    auto task_template = OCXXR_TEMPLATE_FOR(CheckTask);
+    task_template().CreateTask(compact);
+}
@@ -0,0 +1,130 @@
+#include <ocxxr-main.hpp>
+
+#include <cstring>
+
+static constexpr u32 kDbCount = 8;
+static constexpr u32 kNodesPerDb = 100;
+static constexpr u32 kNodes = kDbCount * kNodesPerDb;
+
+// A ring of nodes spread over several datablocks, with extra links
+struct Node {
+    u32 key;
+    ocxxr::BasedPtr<Node> next;
+    ocxxr::BasedPtr<Node> skip;
+};
+
+typedef ocxxr::BasedPtr<Node> NodePtr;
+
+struct Graph {
+    NodePtr head;
+    ocxxr::BasedPtr<NodePtr> entries;  // the first node in each datablock
+};
+
+namespace ocxxr {
+
+template <>
+struct PointerFields<Node> {
+    template <typename V>
+    static void Visit(Node &node, V &visitor) {
+        visitor(node.next);
+        visitor(node.skip);
+    }
+};
+
+template <>
+struct PointerFields<Graph> {
+    template <typename V>
+    static void Visit(Graph &graph, V &visitor) {
+        visitor(graph.head);
+        visitor(graph.entries, kDbCount);
+    }
+};
+
+}  // namespace ocxxr
+
+Node *NodeAt(ocxxr::DatablockList<Node> &dbs, u32 i) {
+    // consecutive nodes are in different datablocks
+    return dbs[i % kDbCount].data_ptr() + i / kDbCount;
+}
+
+u64 Walk(const Graph &graph) {
+    u64 sum = 0;
+    const Node *node = graph.head;
+    for (u32 i = 0; i < kNodes; i++) {
+        ASSERT(node->key == i);
+        ASSERT(node->skip->key == (i * 7) % kNodes);
+        sum += node->skip->key;
+        node = node->next;
+    }
+    ASSERT(node == graph.head);
+    for (u32 i = 0; i < kDbCount; i++) {
+        ASSERT(graph.entries[i]->key == i);
+    }
+    return sum;
+}
+
+void ChildTask(ocxxr::Datablock<Graph> graph, ocxxr::Datablock<NodePtr> entries,
+               ocxxr::DatablockList<Node> dbs) {
+    PRINTF("Child task got %zu datablocks\n", dbs.count());
+    const u64 expected = Walk(*graph);
+    {
+        ocxxr::SwizzleScope<Graph> swizzled(graph.data_ptr());
+        for (u32 i = 0; i < 10; i++) {
+            ASSERT(Walk(*graph) == expected);
+        }
+    }
+    // still fine after unswizzling
+    ASSERT(Walk(*graph) == expected);
+    for (auto db : dbs) {
+        db.Destroy();
+    }
+    entries.Destroy();
+    graph.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto graph = ocxxr::Datablock<Graph>::Create();
+    auto entries = ocxxr::Datablock<NodePtr>::Create(kDbCount);
+    ocxxr::DatablockList<Node> dbs(kDbCount);
+    for (u32 i = 0; i < kDbCount; i++) {
+        dbs.Add(ocxxr::Datablock<Node>::Create(kNodesPerDb));
+    }
+    for (u32 i = 0; i < kNodes; i++) {
+        Node *node = NodeAt(dbs, i);
+        node->key = i;
+        node->next = NodeAt(dbs, (i + 1) % kNodes);
+        node->skip = NodeAt(dbs, (i * 7) % kNodes);
+    }
+    for (u32 i = 0; i < kDbCount; i++) {
+        entries.data_ptr()[i] = NodeAt(dbs, i);
+    }
+    graph->head = NodeAt(dbs, 0);
+    graph->entries = entries.data_ptr();
+    const u64 expected = Walk(*graph);
+
+    // every (non-null) BasedPtr is rewritten once, even though the nodes
+    // are reached several ways
+    constexpr size_t kPointers = 2 + kDbCount + 2 * kNodes;
+    // (compare the raw bytes of a pointer to another datablock)
+    const Node *node = NodeAt(dbs, 1);
+    char original[sizeof(node->next)];
+    std::memcpy(original, &node->next, sizeof(original));
+    const size_t swizzled = ocxxr::SwizzlePointers(graph.data_ptr());
+    ASSERT(swizzled == kPointers);
+    ASSERT(std::memcmp(original, &node->next, sizeof(original)) != 0);
+    ASSERT(Walk(*graph) == expected);
+    const size_t unswizzled = ocxxr::UnswizzlePointers(graph.data_ptr());
+    ASSERT(unswizzled == kPointers);
+    ASSERT(std::memcmp(original, &node->next, sizeof(original)) == 0);
+    ASSERT(Walk(*graph) == expected);
+
+    for (auto db : dbs) {
+        db.Release();
+    }
+    entries.Release();
+    graph.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChildTask);
+    task_template().CreateTask(graph, entries, dbs);
+}
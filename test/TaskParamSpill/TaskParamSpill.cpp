@@ -0,0 +1,119 @@
+#include <ocxxr-main.hpp>
+
+#include <type_traits>
+
+static constexpr u32 kValues = 200;
+static constexpr u32 kExtras = 3;
+static constexpr u64 kTasks = 4;
+
+// too big to pass inline
+struct BigParams {
+    u32 tag;
+    u64 values[kValues];
+};
+
+struct SmallParams {
+    u32 tag;
+};
+
+// small, but always spilled
+struct ForcedParams {
+    u32 tag;
+    u64 value;
+};
+
+namespace ocxxr {
+
+template <>
+struct SpillTaskParam<ForcedParams> : std::true_type {};
+
+}  // namespace ocxxr
+
+static_assert(ocxxr::SpillTaskParam<BigParams>::value,
+              "Parameters bigger than the threshold are spilled.");
+static_assert(!ocxxr::SpillTaskParam<SmallParams>::value,
+              "Small parameters stay inline.");
+
+static BigParams MakeBig(u32 tag) {
+    BigParams params;
+    params.tag = tag;
+    for (u32 i = 0; i < kValues; i++) {
+        params.values[i] = tag * 1000 + i;
+    }
+    return params;
+}
+
+static void CheckBig(const BigParams &params, u32 tag) {
+    ASSERT(params.tag == tag);
+    for (u32 i = 0; i < kValues; i++) {
+        ASSERT(params.values[i] == tag * 1000 + i);
+    }
+}
+
+// the last task to finish shuts down
+static void Finish(ocxxr::Datablock<u64> counter) {
+    if (__atomic_add_fetch(counter.data_ptr(), 1, __ATOMIC_ACQ_REL) ==
+        kTasks) {
+        counter.Destroy();
+        PRINTF("Shutting down...\n");
+        ocxxr::Shutdown();
+    }
+}
+
+void BigTask(const BigParams &params, ocxxr::Datablock<u64> counter) {
+    PRINTF("BigTask %" PRIu32 "\n", params.tag);
+    CheckBig(params, params.tag);
+    Finish(counter);
+}
+
+// the spilled parameter's slot sits between the dependences and VarArgs
+void BigVarArgsTask(BigParams params, ocxxr::Datablock<u64> counter,
+                    ocxxr::DatablockList<u32> extras) {
+    PRINTF("BigVarArgsTask\n");
+    CheckBig(params, 2);
+    ASSERT(extras.count() == kExtras);
+    for (u32 i = 0; i < kExtras; i++) {
+        ASSERT(*extras[i] == 10 + i);
+        extras[i].Destroy();
+    }
+    Finish(counter);
+}
+
+void ForcedTask(ForcedParams params, ocxxr::Datablock<u64> counter) {
+    PRINTF("ForcedTask\n");
+    ASSERT(params.tag == 3 && params.value == 33);
+    Finish(counter);
+}
+
+void SmallTask(SmallParams params, ocxxr::Datablock<u64> counter) {
+    PRINTF("SmallTask\n");
+    ASSERT(params.tag == 4);
+    Finish(counter);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto counter = ocxxr::Datablock<u64>::Create();
+    *counter = 0;
+    counter.Release();
+
+    auto big_template = OCXXR_TEMPLATE_FOR(BigTask);
+    big_template().CreateTask(MakeBig(1), counter);
+
+    ocxxr::DatablockList<u32> extras(kExtras);
+    for (u32 i = 0; i < kExtras; i++) {
+        auto extra = ocxxr::Datablock<u32>::Create();
+        *extra = 10 + i;
+        extra.Release();
+        extras.Add(extra);
+    }
+    auto var_args_template = OCXXR_TEMPLATE_FOR(BigVarArgsTask);
+    var_args_template().CreateTask(MakeBig(2), counter, extras);
+
+    // the dependence is added after the task (and its parameter) exist
+    auto forced_template = OCXXR_TEMPLATE_FOR(ForcedTask);
+    auto forced = forced_template().CreateTaskPartial({3, 33});
+    forced.DependOn<0>(counter);
+
+    auto small_template = OCXXR_TEMPLATE_FOR(SmallTask);
+    small_template().CreateTask({4}, counter);
+}
@@ -0,0 +1,39 @@
+#include <ocxxr-main.hpp>
+
+// Task states get recycled, so stale bookkeeping from earlier tasks
+// (e.g., datablocks at reused addresses) must not leak into later tasks.
+static constexpr u32 kChainLength = 50;
+
+typedef ocxxr::BasedPtr<u32> Ptr;
+
+void ChainTask(u32 step, ocxxr::Datablock<Ptr> ptr, ocxxr::Datablock<u32> db) {
+    ASSERT(**ptr == step);
+    ASSERT(&**ptr == db.data_ptr());
+    ptr.Destroy();
+    db.Destroy();
+    if (step == kChainLength) {
+        PRINTF("Task %" PRIu32 " done. Shutting down...\n", step);
+        ocxxr::Shutdown();
+        return;
+    }
+    auto next_ptr = ocxxr::Datablock<Ptr>::Create();
+    auto next_db = ocxxr::Datablock<u32>::Create();
+    *next_db = step + 1;
+    *next_ptr = next_db.data_ptr();
+    next_ptr.Release();
+    next_db.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChainTask);
+    task_template().CreateTask(step + 1, next_ptr, next_db);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    PRINTF("Starting a chain of %" PRIu32 " tasks\n", kChainLength);
+    auto ptr = ocxxr::Datablock<Ptr>::Create();
+    auto db = ocxxr::Datablock<u32>::Create();
+    *db = 1;
+    *ptr = db.data_ptr();
+    ptr.Release();
+    db.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(ChainTask);
+    task_template().CreateTask(1, ptr, db);
+}
@@ -0,0 +1,60 @@
+#include <ocxxr-main.hpp>
+
+static constexpr u32 kPayload = 321;
+
+typedef ocxxr::BasedPtr<u32> Ptr;
+
+struct Pair {
+    u32 value;
+    ocxxr::RelPtr<u32> ptr;
+};
+
+// Tracked task: dereferences a BasedPtr created by its parent
+void CheckTask(ocxxr::Datablock<Ptr> ptr, ocxxr::Datablock<u32> db) {
+    PRINTF("Checking based pointer in tracked task\n");
+    ASSERT(**ptr == kPayload);
+    ASSERT(&**ptr == db.data_ptr());
+    ptr.Destroy();
+    db.Destroy();
+    PRINTF("Shutting down...\n");
+    ocxxr::Shutdown();
+}
+
+// Tracked task: forms a BasedPtr to another datablock
+void InitTask(ocxxr::Datablock<Ptr> ptr, ocxxr::Datablock<u32> db) {
+    *ptr = db.data_ptr();
+    ptr.Release();
+    db.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(CheckTask);
+    task_template().CreateTask(ptr, db);
+}
+
+// Untracked task: uses only raw and relative pointers
+void UntrackedTask(ocxxr::DatablockList<Pair> pairs) {
+    PRINTF("Running untracked task\n");
+    ASSERT(pairs.count() == 1);
+    auto pair = pairs[0];
+    ASSERT(*pair->ptr == kPayload);
+    // creating and releasing datablocks still works without tracking
+    auto db = ocxxr::Datablock<u32>::Create();
+    *db = *pair->ptr;
+    db.Release();
+    pair.Destroy();
+    auto ptr = ocxxr::Datablock<Ptr>::Create();
+    ptr.Release();
+    auto task_template = OCXXR_TEMPLATE_FOR(InitTask);
+    task_template().CreateTask(ptr, db);
+}
+
+void ocxxr::Main(ocxxr::Datablock<ocxxr::MainTaskArgs>) {
+    auto pair = ocxxr::Datablock<Pair>::Create();
+    pair->value = kPayload;
+    pair->ptr = &pair->value;
+    pair.Release();
+    ocxxr::DatablockList<Pair> pairs(1);
+    pairs.Add(pair);
+    PRINTF("Creating untracked task\n");
+    typedef ocxxr::UntrackedTaskPolicy Policy;
+    auto task_template = OCXXR_TEMPLATE_WITH_POLICY(UntrackedTask, Policy);
+    task_template().CreateTask(pairs);
+}